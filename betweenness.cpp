@@ -0,0 +1,175 @@
+#include "betweenness.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <unordered_map>
+using namespace std;
+
+namespace
+{
+// Scratch state for one thread's searches.
+struct BrandesWorkspace
+{
+    vector<double> dist;
+    vector<double> sigma;
+    vector<double> delta;
+    vector<char> settled;
+    // Arcs into each node on its shortest paths from the source.
+    vector<vector<int>> predecessors;
+    vector<int> order;
+    vector<int> touched;
+    vector<pair<double, int>> heap;
+    vector<double> arcScore;
+
+    BrandesWorkspace(int n, size_t arcs)
+        : dist(n, numeric_limits<double>::infinity()), sigma(n, 0), delta(n, 0), settled(n, 0), predecessors(n),
+          arcScore(arcs, 0)
+    {
+    }
+};
+
+void accumulateSource(const FlightGraph &graph, const vector<char> &usable, const vector<size_t> &firstArc,
+                      const vector<int> &arcSource, int s, BrandesWorkspace &ws)
+{
+    using PDI = pair<double, int>;
+    for (int v : ws.touched)
+    {
+        ws.dist[v] = numeric_limits<double>::infinity();
+        ws.sigma[v] = 0;
+        ws.delta[v] = 0;
+        ws.settled[v] = 0;
+        ws.predecessors[v].clear();
+    }
+    ws.touched.clear();
+    ws.order.clear();
+
+    ws.dist[s] = 0;
+    ws.sigma[s] = 1;
+    ws.touched.push_back(s);
+    ws.heap.clear();
+    ws.heap.push_back({0, s});
+    while (!ws.heap.empty())
+    {
+        pop_heap(ws.heap.begin(), ws.heap.end(), greater<PDI>());
+        auto [d, u] = ws.heap.back();
+        ws.heap.pop_back();
+        if (ws.settled[u] || d > ws.dist[u])
+        continue;
+        ws.settled[u] = 1;
+        ws.order.push_back(u);
+
+        size_t arc = firstArc[u];
+        for (auto [v, w] : graph.adj[u])
+        {
+            size_t a = arc++;
+            if (!usable[a] || ws.settled[v])
+            continue;
+            double nd = d + w;
+            // Distances are sums of doubles, so "equally short" needs a
+            // tolerance or ties would depend on the order of addition.
+            double tolerance = 1e-9 * max(1.0, nd);
+            if (nd < ws.dist[v] - tolerance)
+            {
+                if (ws.dist[v] == numeric_limits<double>::infinity())
+                ws.touched.push_back(v);
+                ws.dist[v] = nd;
+                ws.sigma[v] = ws.sigma[u];
+                ws.predecessors[v].assign(1, static_cast<int>(a));
+                ws.heap.push_back({nd, v});
+                push_heap(ws.heap.begin(), ws.heap.end(), greater<PDI>());
+            }
+            else if (nd <= ws.dist[v] + tolerance)
+            {
+                ws.sigma[v] += ws.sigma[u];
+                ws.predecessors[v].push_back(static_cast<int>(a));
+            }
+        }
+    }
+
+    // Farthest first, so each node's dependency is complete before it is
+    // passed on to its predecessors.
+    for (size_t i = ws.order.size(); i-- > 0;)
+    {
+        int w = ws.order[i];
+        for (int a : ws.predecessors[w])
+        {
+            int v = arcSource[a];
+            double share = ws.sigma[v] / ws.sigma[w] * (1 + ws.delta[w]);
+            ws.arcScore[a] += share;
+            ws.delta[v] += share;
+        }
+    }
+}
+} // namespace
+
+vector<EdgeBetweenness> edgeBetweenness(const FlightGraph &graph, const vector<char> &usable,
+                                        const BetweennessOptions &options)
+{
+    TRACE_SCOPE("edgeBetweenness");
+    int n = graph.adj.size();
+    vector<size_t> firstArc(n + 1, 0);
+    for (int u = 0; u < n; ++u)
+    firstArc[u + 1] = firstArc[u] + graph.adj[u].size();
+    size_t arcs = firstArc[n];
+    vector<int> arcSource(arcs);
+    for (int u = 0; u < n; ++u)
+    fill(arcSource.begin() + firstArc[u], arcSource.begin() + firstArc[u + 1], u);
+
+    vector<int> sources(n);
+    iota(sources.begin(), sources.end(), 0);
+    double scale = 1;
+    if (options.samples > 0 && options.samples < n)
+    {
+        mt19937 rng(options.seed);
+        shuffle(sources.begin(), sources.end(), rng);
+        sources.resize(options.samples);
+        scale = double(n) / options.samples;
+    }
+
+    int threads = options.threads > 0 ? options.threads : max(1u, thread::hardware_concurrency());
+    threads = max(1, min<int>(threads, sources.size()));
+    vector<BrandesWorkspace> workspaces;
+    workspaces.reserve(threads);
+    for (int t = 0; t < threads; ++t)
+    workspaces.emplace_back(n, arcs);
+
+    atomic<size_t> next{0};
+    auto work = [&](BrandesWorkspace &ws)
+    {
+        for (size_t i = next++; i < sources.size(); i = next++)
+        accumulateSource(graph, usable, firstArc, arcSource, sources[i], ws);
+    };
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t)
+    pool.emplace_back(work, ref(workspaces[t]));
+    work(workspaces[0]);
+    for (thread &worker : pool)
+    worker.join();
+
+    for (int t = 1; t < threads; ++t)
+    for (size_t a = 0; a < arcs; ++a)
+    workspaces[0].arcScore[a] += workspaces[t].arcScore[a];
+    const vector<double> &arcScore = workspaces[0].arcScore;
+
+    // Each pair is counted from both ends, once along each direction of the
+    // segment, so the two arcs are summed and halved.
+    vector<EdgeBetweenness> scores;
+    unordered_map<long long, size_t> edgeIndex;
+    for (int u = 0; u < n; ++u)
+    for (size_t a = firstArc[u]; a < firstArc[u + 1]; ++a)
+    {
+        int v = graph.adj[u][a - firstArc[u]].first;
+        long long key = (long long)min(u, v) * n + max(u, v);
+        auto [it, inserted] = edgeIndex.emplace(key, scores.size());
+        if (inserted)
+        scores.push_back({min(u, v), max(u, v), 0});
+        scores[it->second].score += arcScore[a] * scale / 2;
+    }
+    stable_sort(scores.begin(), scores.end(),
+                [](const EdgeBetweenness &a, const EdgeBetweenness &b) { return a.score > b.score; });
+    return scores;
+}
@@ -0,0 +1,44 @@
+#ifndef BETWEENNESS_H
+#define BETWEENNESS_H
+
+#include <vector>
+#include "flight_graph.h"
+
+struct BetweennessOptions
+{
+    // Worker threads; 0 uses one per hardware thread.
+    int threads = 0;
+    // Sources to sample; 0 (or at least the airport count) runs every
+    // airport exactly. Sampled scores are scaled up to estimate the total.
+    int samples = 0;
+    unsigned seed = 1;
+};
+
+// Score of one route segment: over all airport pairs, the number of
+// shortest routes that use it, each pair's share split evenly between its
+// equally short routes. Closing a high-scoring segment reroutes the most
+// traffic, assuming equal demand between every pair.
+struct EdgeBetweenness
+{
+    int u;
+    int v;
+    double score;
+};
+
+// Weighted edge betweenness with Brandes' algorithm: one Dijkstra per
+// source that counts shortest paths, then a pass back over the settled
+// order that hands each node's dependency to the edges into it. Sources are
+// shared out between threads, each adding into its own per-edge totals,
+// which are summed at the end. Returns every segment, highest score first.
+// Reads only graph.adj, so the weather may change while it runs.
+std::vector<EdgeBetweenness> edgeBetweenness(const FlightGraph &graph, const std::vector<char> &usable,
+                                             const BetweennessOptions &options = {});
+
+template <typename Available>
+std::vector<EdgeBetweenness> edgeBetweenness(const FlightGraph &graph, const Available &available,
+                                             const BetweennessOptions &options = {})
+{
+    return edgeBetweenness(graph, usableArcs(graph, available), options);
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef CLI_ARGS_H
+#define CLI_ARGS_H
+
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// Parses the value given for a command-line option, which must be all of
+// `text`. Throws std::invalid_argument naming the option if it is not a
+// number or does not fit in T.
+template <typename T>
+T parseArg(const std::string &option, const char *text)
+{
+    T value{};
+    const char *end = text + std::strlen(text);
+    auto [ptr, ec] = std::from_chars(text, end, value);
+    if (ec != std::errc() || ptr != end)
+    throw std::invalid_argument("invalid value for " + option + ": " + text);
+    return value;
+}
+
+#endif
@@ -1,7 +1,32 @@
 echo off
 
+set PROJECT_DIR=C:\Users\USER\OneDrive\Desktop\Dijkstra PathFinder Visualizer
+set SFML_DIR=C:\SFML-2.6.2
+set CXXFLAGS=-std=c++17 -O2
+rem Add -DROUTING_STATS=1 to CXXFLAGS to build in search counters and latency histograms.
+
+echo Compiling routing library...
+for %%f in (flight_graph weather_grid weather_epochs route_cache route_tuner weather_history weather_ingest sim_channel routing_stats trace event_sim search_trace fleet_animation quadtree route_worker betweenness replacement_paths) do (
+    g++ %CXXFLAGS% -c "%PROJECT_DIR%\%%f.cpp" -o "%PROJECT_DIR%\%%f.o"
+    if errorlevel 1 (
+        echo Error compiling %%f.cpp
+        pause
+        exit /b 1
+    )
+)
+
+echo Archiving libflightrouting.a...
+pushd "%PROJECT_DIR%"
+ar rcs libflightrouting.a flight_graph.o weather_grid.o weather_epochs.o route_cache.o route_tuner.o weather_history.o weather_ingest.o sim_channel.o routing_stats.o trace.o event_sim.o search_trace.o fleet_animation.o quadtree.o route_worker.o betweenness.o replacement_paths.o
+popd
+if %ERRORLEVEL% NEQ 0 (
+    echo Error archiving libflightrouting.a
+    pause
+    exit /b 1
+)
+
 echo Compiling flight_booking.cpp...
-g++ -IC:\SFML-2.6.2\include -c "C:\Users\USER\OneDrive\Desktop\Dijkstra PathFinder Visualizer\flight_booking.cpp" -o "C:\Users\USER\OneDrive\Desktop\Dijkstra PathFinder Visualizer\flight_booking.o"
+g++ %CXXFLAGS% -I%SFML_DIR%\include -c "%PROJECT_DIR%\flight_booking.cpp" -o "%PROJECT_DIR%\flight_booking.o"
 if %ERRORLEVEL% NEQ 0 (
     echo Error compiling flight_booking.cpp
     pause
@@ -9,15 +34,43 @@ if %ERRORLEVEL% NEQ 0 (
 )
 
 echo Linking flight_booking.exe...
-g++ "C:\Users\USER\OneDrive\Desktop\Dijkstra PathFinder Visualizer\flight_booking.o" -o "C:\Users\USER\OneDrive\Desktop\Dijkstra PathFinder Visualizer\flight_booking.exe"
+g++ "%PROJECT_DIR%\flight_booking.o" -o "%PROJECT_DIR%\flight_booking.exe" -L"%PROJECT_DIR%" -lflightrouting
 if %ERRORLEVEL% NEQ 0 (
     echo Error linking flight_booking.exe
     pause
     exit /b 1
 )
 
+for %%f in (route_cli route_bench day_sim history_bench) do (
+    echo Compiling and linking %%f.exe...
+    g++ %CXXFLAGS% "%PROJECT_DIR%\%%f.cpp" -o "%PROJECT_DIR%\%%f.exe" -L"%PROJECT_DIR%" -lflightrouting
+    if errorlevel 1 (
+        echo Error building %%f.exe
+        pause
+        exit /b 1
+    )
+)
+
+for %%f in (route_server route_loadgen weather_replay) do (
+    echo Compiling and linking %%f.exe...
+    g++ %CXXFLAGS% -I%SFML_DIR%\include "%PROJECT_DIR%\%%f.cpp" -o "%PROJECT_DIR%\%%f.exe" -L"%PROJECT_DIR%" -lflightrouting -L%SFML_DIR%\lib -lsfml-network -lsfml-system -lws2_32
+    if errorlevel 1 (
+        echo Error building %%f.exe
+        pause
+        exit /b 1
+    )
+)
+
+echo Compiling and linking render_bench.exe...
+g++ %CXXFLAGS% -I%SFML_DIR%\include "%PROJECT_DIR%\render_bench.cpp" -o "%PROJECT_DIR%\render_bench.exe" -L"%PROJECT_DIR%" -lflightrouting -L%SFML_DIR%\lib -lsfml-graphics -lsfml-window -lsfml-system -lopengl32
+if %ERRORLEVEL% NEQ 0 (
+    echo Error building render_bench.exe
+    pause
+    exit /b 1
+)
+
 echo  Compiling flight_simulator.cpp...
-g++ -IC:\SFML-2.6.2\include -c "C:\Users\USER\OneDrive\Desktop\Dijkstra PathFinder Visualizer\flight_simulator.cpp" -o "C:\Users\USER\OneDrive\Desktop\Dijkstra PathFinder Visualizer\flight_simulator.o"
+g++ %CXXFLAGS% -I%SFML_DIR%\include -c "%PROJECT_DIR%\flight_simulator.cpp" -o "%PROJECT_DIR%\flight_simulator.o"
 if %ERRORLEVEL% NEQ 0 (
     echo Error compiling flight_simulator.cpp
     pause
@@ -25,7 +78,7 @@ if %ERRORLEVEL% NEQ 0 (
 )
 
 echo Linking flight_simulator.exe with SFML...
-g++ "C:\Users\USER\OneDrive\Desktop\Dijkstra PathFinder Visualizer\flight_simulator.o" -o "C:\Users\USER\OneDrive\Desktop\Dijkstra PathFinder Visualizer\flight_simulator.exe" -LC:\SFML-2.6.2\lib -lsfml-graphics -lsfml-window -lsfml-system
+g++ "%PROJECT_DIR%\flight_simulator.o" -o "%PROJECT_DIR%\flight_simulator.exe" -L"%PROJECT_DIR%" -lflightrouting -L%SFML_DIR%\lib -lsfml-graphics -lsfml-window -lsfml-system
 if %ERRORLEVEL% NEQ 0 (
     echo Error linking flight_simulator.exe
     pause
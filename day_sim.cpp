@@ -0,0 +1,170 @@
+// day_sim.cpp
+// Headless discrete-event run of a day of traffic on the default network:
+// a random schedule of flights and random storms over 24 hours, simulated
+// with EventSimulation. Prints a summary and writes one CSV line per flight
+// (delay, reroutes, distance flown, outcome).
+//
+// Usage: day_sim [--flights N] [--storms N] [--seed N] [--speed UNITS_PER_HOUR]
+//                [--hold-minutes N] [--output FILE] [--trace FILE]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "cli_args.h"
+#include "event_sim.h"
+#include "flight_graph.h"
+#include "trace.h"
+using namespace std;
+
+struct DaySimOptions
+{
+    int flights = 50000;
+    int storms = 300;
+    unsigned seed = 42;
+    EventSimOptions sim;
+    string output = "outcomes.csv";
+    string trace;
+};
+
+void printUsage()
+{
+    cerr << "Usage: day_sim [--flights N] [--storms N] [--seed N] [--speed UNITS_PER_HOUR]"
+            " [--hold-minutes N] [--output FILE] [--trace FILE]" << endl;
+}
+
+bool parseOptions(int argc, char *argv[], DaySimOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--flights" && i + 1 < argc)
+        options.flights = parseArg<int>(arg, argv[++i]);
+        else if (arg == "--storms" && i + 1 < argc)
+        options.storms = parseArg<int>(arg, argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc)
+        options.seed = parseArg<unsigned>(arg, argv[++i]);
+        else if (arg == "--speed" && i + 1 < argc)
+        options.sim.speed = parseArg<double>(arg, argv[++i]);
+        else if (arg == "--hold-minutes" && i + 1 < argc)
+        {
+            // A held flight retries after holdSeconds, so a zero hold would
+            // retry forever at the same instant.
+            uint32_t minutes = parseArg<uint32_t>(arg, argv[++i]);
+            if (minutes < 1 || minutes > 24 * 60)
+            {
+                cerr << "--hold-minutes must be between 1 and " << 24 * 60 << endl;
+                return false;
+            }
+            options.sim.holdSeconds = minutes * 60;
+        }
+        else if (arg == "--output" && i + 1 < argc)
+        options.output = argv[++i];
+        else if (arg == "--trace" && i + 1 < argc)
+        options.trace = argv[++i];
+        else
+        {
+            cerr << "Unknown argument: " << arg << endl;
+            printUsage();
+            return false;
+        }
+    }
+    return options.flights >= 0 && options.storms >= 0 && options.sim.speed > 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const uint32_t day = 24 * 3600;
+
+    DaySimOptions options;
+    try
+    {
+        if (!parseOptions(argc, argv, options))
+        return 1;
+    }
+    catch (const invalid_argument &e)
+    {
+        cerr << e.what() << endl;
+        printUsage();
+        return 1;
+    }
+
+    TraceSession traceSession(options.trace);
+    FlightGraph graph;
+    buildDefaultNetwork(graph);
+    int n = graph.airports.size();
+
+    EventSimulation sim(graph, options.sim);
+    mt19937 rng(options.seed);
+    uniform_int_distribution<uint32_t> departureTime(0, day - 1);
+    for (int i = 0; i < options.flights; ++i)
+    {
+        int src = rng() % n;
+        int dst = (src + 1 + rng() % (n - 1)) % n;
+        sim.addFlight(src, dst, departureTime(rng));
+    }
+
+    vector<pair<int, int>> edges;
+    for (int u = 0; u < n; ++u)
+    for (auto [v, w] : graph.adj[u])
+    if (u < v)
+    edges.push_back({u, v});
+    uniform_int_distribution<uint32_t> stormLength(30 * 60, 4 * 3600);
+    for (int i = 0; i < options.storms && !edges.empty(); ++i)
+    {
+        auto [u, v] = edges[rng() % edges.size()];
+        uint32_t start = departureTime(rng);
+        sim.addStorm(u, v, start, start + stormLength(rng));
+    }
+
+    auto start = chrono::steady_clock::now();
+    sim.run();
+    chrono::duration<double> wall = chrono::steady_clock::now() - start;
+
+    // Outcome counts by status, and delays of landed flights.
+    int byStatus[int(FlightStatus::Diverted) + 1] = {};
+    vector<int64_t> delays;
+    double distance = 0;
+    for (const FlightRecord &flight : sim.flights())
+    {
+        ++byStatus[int(flight.status)];
+        distance += flight.distanceFlown;
+        if (flight.status == FlightStatus::Landed)
+        delays.push_back(sim.arrivalDelay(flight));
+    }
+    sort(delays.begin(), delays.end());
+    double meanDelay = 0;
+    for (int64_t delay : delays)
+    meanDelay += delay;
+    if (!delays.empty())
+    meanDelay /= delays.size();
+    auto percentile = [&](double p) { return delays.empty() ? 0 : delays[size_t(p * (delays.size() - 1))]; };
+
+    const EventSimStats &stats = sim.stats();
+    cout << "Flights: " << options.flights << " over " << n << " airports, " << stats.stormsStarted << " storms" << endl;
+    for (int s = 0; s <= int(FlightStatus::Diverted); ++s)
+    if (byStatus[s])
+    cout << "  " << flightStatusName(FlightStatus(s)) << ": " << byStatus[s] << endl;
+    cout << "Delay (landed, s): mean " << meanDelay << ", p50 " << percentile(0.5) << ", p95 " << percentile(0.95)
+         << ", max " << percentile(1) << endl;
+    cout << "Reroutes: " << stats.reroutes << ", turn backs: " << stats.turnBacks << ", holds: " << stats.holds
+         << ", distance flown: " << distance << endl;
+    cout << "Events: " << stats.events << ", searches: " << stats.searches << ", simulated " << sim.now() / 3600.0
+         << " h in " << wall.count() * 1000 << " ms (" << sim.now() / max(wall.count(), 1e-9) << "x real time)"
+         << endl;
+
+    if (!options.output.empty())
+    {
+        if (!sim.writeOutcomes(options.output))
+        {
+            cerr << "Cannot write outcomes: " << options.output << endl;
+            return 1;
+        }
+        cout << "Outcomes written to " << options.output << endl;
+    }
+    return 0;
+}
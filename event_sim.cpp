@@ -0,0 +1,303 @@
+#include "event_sim.h"
+#include <cmath>
+#include <cstdio>
+using namespace std;
+
+const char *flightStatusName(FlightStatus status)
+{
+    switch (status)
+    {
+    case FlightStatus::Scheduled:
+        return "scheduled";
+    case FlightStatus::Airborne:
+        return "airborne";
+    case FlightStatus::Returning:
+        return "returning";
+    case FlightStatus::Holding:
+        return "holding";
+    case FlightStatus::Landed:
+        return "landed";
+    case FlightStatus::Cancelled:
+        return "cancelled";
+    case FlightStatus::Diverted:
+        return "diverted";
+    default:
+        return "unknown";
+    }
+}
+
+EventSimulation::EventSimulation(const FlightGraph &graph, EventSimOptions options)
+    : graph([&graph]
+      {
+          TRACE_SCOPE("copyGraph");
+          return graph;
+      }()),
+      options(options)
+{
+    stormDescription = this->graph.strings->intern("Thunderstorm");
+    clearDescription = this->graph.strings->intern("Clear skies");
+}
+
+uint32_t EventSimulation::addFlight(int src, int dst, uint32_t departure)
+{
+    uint32_t id = records.size();
+    records.push_back({src, dst, departure});
+    wheel.schedule(departure, {Depart, id, 0});
+    return id;
+}
+
+uint32_t EventSimulation::addStorm(int u, int v, uint32_t start, uint32_t end)
+{
+    uint32_t id = storms.size();
+    storms.push_back({min(u, v), max(u, v)});
+    wheel.schedule(start, {StormStart, id, 0});
+    wheel.schedule(max(start, end), {StormEnd, id, 0});
+    return id;
+}
+
+void EventSimulation::run(uint32_t until)
+{
+    TRACE_SCOPE("eventSimulation");
+    wheel.runUntil(until, [this](uint64_t, const Event &event) { fire(event); });
+}
+
+void EventSimulation::fire(const Event &event)
+{
+    ++counters.events;
+    if (event.kind == StormStart)
+    return startStorm(event.id);
+    if (event.kind == StormEnd)
+    return endStorm(event.id);
+
+    // Arrivals and retries are superseded by a turn back or a new plan.
+    if (event.kind != Depart && event.generation != records[event.id].generation)
+    return;
+    switch (event.kind)
+    {
+    case Depart:
+        depart(event.id);
+        break;
+    case Arrive:
+        arrive(event.id);
+        break;
+    case ReturnArrive:
+        returnArrive(event.id);
+        break;
+    case Retry:
+        if (records[event.id].status == FlightStatus::Scheduled)
+        depart(event.id);
+        else
+        continueFrom(event.id, true);
+        break;
+    default:
+        break;
+    }
+}
+
+uint32_t EventSimulation::secondsFor(double distance) const
+{
+    return max<uint32_t>(1, static_cast<uint32_t>(lround(distance / options.speed * 3600)));
+}
+
+bool EventSimulation::plan(FlightRecord &flight, int from)
+{
+    ++counters.searches;
+    vector<int> path = graph.dijkstra(from, flight.dst, [this](int u, int v) { return graph.available(u, v); },
+                                      workspace);
+    if (path.empty())
+    return false;
+    flight.routeOffset = routes.size();
+    flight.routeLength = path.size();
+    flight.leg = 0;
+    flight.planEpoch = epoch;
+    routes.insert(routes.end(), path.begin(), path.end());
+    return true;
+}
+
+void EventSimulation::depart(uint32_t id)
+{
+    FlightRecord &flight = records[id];
+    if (flight.nominalDistance < 0)
+    {
+        ++counters.searches;
+        vector<int> direct = graph.dijkstra(flight.src, flight.dst, [](int, int) { return true; }, workspace);
+        flight.nominalDistance = graph.pathLength(direct);
+    }
+
+    if (!plan(flight, flight.src))
+    {
+        if (now() - flight.scheduledDeparture >= options.maxHoldSeconds)
+        {
+            flight.status = FlightStatus::Cancelled;
+            return;
+        }
+        ++counters.holds;
+        wheel.schedule(now() + options.holdSeconds, {Retry, id, ++flight.generation});
+        return;
+    }
+
+    // Weather already forces a longer route than the clear-weather one (the
+    // tolerance covers nominalDistance being stored as a float).
+    if (graph.pathLength({routes.begin() + flight.routeOffset, routes.begin() + flight.routeOffset + flight.routeLength}) >
+        flight.nominalDistance * (1 + 1e-5))
+    {
+        ++flight.reroutes;
+        ++counters.reroutes;
+    }
+    flight.departure = now();
+    flight.status = FlightStatus::Airborne;
+    startLeg(id);
+}
+
+void EventSimulation::startLeg(uint32_t id)
+{
+    FlightRecord &flight = records[id];
+    int u = node(flight, flight.leg);
+    int v = node(flight, flight.leg + 1);
+    vector<uint32_t> &flying = airborne[edgeIndex(u, v)];
+    flight.legSlot = flying.size();
+    flying.push_back(id);
+    flight.legStart = now();
+    wheel.schedule(now() + secondsFor(graph.edgeLength(u, v)), {Arrive, id, ++flight.generation});
+}
+
+void EventSimulation::leaveLeg(uint32_t id)
+{
+    FlightRecord &flight = records[id];
+    vector<uint32_t> &flying = airborne[edgeIndex(node(flight, flight.leg), node(flight, flight.leg + 1))];
+    uint32_t moved = flying.back();
+    flying[flight.legSlot] = moved;
+    records[moved].legSlot = flight.legSlot;
+    flying.pop_back();
+}
+
+void EventSimulation::arrive(uint32_t id)
+{
+    FlightRecord &flight = records[id];
+    leaveLeg(id);
+    flight.distanceFlown += graph.edgeLength(node(flight, flight.leg), node(flight, flight.leg + 1));
+    ++flight.leg;
+    if (flight.leg + 1 == flight.routeLength)
+    {
+        flight.status = FlightStatus::Landed;
+        flight.arrival = now();
+        return;
+    }
+    continueFrom(id, false);
+}
+
+void EventSimulation::continueFrom(uint32_t id, bool force)
+{
+    FlightRecord &flight = records[id];
+    bool replan = force;
+    for (int i = flight.leg; !replan && flight.planEpoch != epoch && i + 1 < flight.routeLength; ++i)
+    replan = !graph.available(node(flight, i), node(flight, i + 1));
+
+    if (replan)
+    {
+        if (!plan(flight, node(flight, flight.leg)))
+        return hold(id);
+        ++flight.reroutes;
+        ++counters.reroutes;
+    }
+    flight.status = FlightStatus::Airborne;
+    startLeg(id);
+}
+
+void EventSimulation::hold(uint32_t id)
+{
+    FlightRecord &flight = records[id];
+    if (flight.status != FlightStatus::Holding)
+    {
+        flight.status = FlightStatus::Holding;
+        flight.legStart = now();
+    }
+    if (now() - flight.legStart >= options.maxHoldSeconds)
+    {
+        flight.status = FlightStatus::Diverted;
+        flight.arrival = now();
+        return;
+    }
+    ++counters.holds;
+    wheel.schedule(now() + options.holdSeconds, {Retry, id, ++flight.generation});
+}
+
+void EventSimulation::turnBack(uint32_t id)
+{
+    // Flies back the way it came; the pending arrival is superseded.
+    FlightRecord &flight = records[id];
+    uint32_t elapsed = now() - flight.legStart;
+    flight.distanceFlown += options.speed * elapsed / 3600;
+    flight.status = FlightStatus::Returning;
+    flight.legStart = now();
+    ++counters.turnBacks;
+    wheel.schedule(now() + elapsed, {ReturnArrive, id, ++flight.generation});
+}
+
+void EventSimulation::returnArrive(uint32_t id)
+{
+    FlightRecord &flight = records[id];
+    flight.distanceFlown += options.speed * (now() - flight.legStart) / 3600;
+    continueFrom(id, true);
+}
+
+void EventSimulation::startStorm(uint32_t id)
+{
+    const Storm &storm = storms[id];
+    ++counters.stormsStarted;
+    if (activeStorms[edgeIndex(storm.u, storm.v)]++ > 0)
+    return;
+    graph.updateWeather(storm.u, storm.v, true, stormDescription);
+    ++epoch;
+
+    for (uint32_t edge : {edgeIndex(storm.u, storm.v), edgeIndex(storm.v, storm.u)})
+    {
+        auto it = airborne.find(edge);
+        if (it == airborne.end())
+        continue;
+        vector<uint32_t> flying;
+        flying.swap(it->second);
+        for (uint32_t flight : flying)
+        turnBack(flight);
+    }
+}
+
+void EventSimulation::endStorm(uint32_t id)
+{
+    const Storm &storm = storms[id];
+    if (--activeStorms[edgeIndex(storm.u, storm.v)] > 0)
+    return;
+    graph.updateWeather(storm.u, storm.v, false, clearDescription);
+    ++epoch;
+}
+
+int64_t EventSimulation::arrivalDelay(const FlightRecord &flight) const
+{
+    return int64_t(flight.arrival) - int64_t(flight.scheduledDeparture) - int64_t(secondsFor(flight.nominalDistance));
+}
+
+bool EventSimulation::writeOutcomes(const string &path) const
+{
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f)
+    return false;
+    fprintf(f, "flight,src,dst,scheduled_departure,departure,arrival,delay_s,reroutes,distance,status\n");
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const FlightRecord &flight = records[i];
+        bool landed = flight.status == FlightStatus::Landed;
+        bool departed = flight.status != FlightStatus::Scheduled && flight.status != FlightStatus::Cancelled;
+        string src(graph.airportCode(flight.src)), dst(graph.airportCode(flight.dst));
+        fprintf(f, "%zu,%s,%s,%u,", i, src.c_str(), dst.c_str(), flight.scheduledDeparture);
+        if (departed)
+        fprintf(f, "%u,", flight.departure);
+        else
+        fprintf(f, ",");
+        if (landed)
+        fprintf(f, "%u,%lld,", flight.arrival, (long long)arrivalDelay(flight));
+        else
+        fprintf(f, ",,");
+        fprintf(f, "%u,%.1f,%s\n", flight.reroutes, flight.distanceFlown, flightStatusName(flight.status));
+    }
+    return fclose(f) == 0;
+}
@@ -0,0 +1,167 @@
+#ifndef EVENT_SIM_H
+#define EVENT_SIM_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "flight_graph.h"
+#include "timing_wheel.h"
+
+// Discrete-event simulation of a day of operations on a FlightGraph. Time is
+// in whole seconds; events wait on a TimingWheel and nothing happens between
+// them, so a day runs in well under a second of wall time.
+//
+// A flight plans its weather-aware route at departure and flies it leg by
+// leg. At each waypoint it re-plans if the weather changed since it planned
+// and the rest of its route now crosses bad weather. A storm closing the
+// leg a flight is on turns it back to the airport it left, where it
+// re-plans. A flight with no usable route holds (on the ground before
+// departure, or at a waypoint) and retries every holdSeconds; after
+// maxHoldSeconds it is cancelled or, once airborne, diverted.
+
+struct EventSimOptions
+{
+    // Cruise speed in map units per hour (JFK-LAX is about 3.4 h at 120).
+    double speed = 120;
+    std::uint32_t holdSeconds = 15 * 60;
+    std::uint32_t maxHoldSeconds = 6 * 3600;
+};
+
+enum class FlightStatus : std::uint8_t
+{
+    Scheduled,
+    Airborne,
+    Returning,
+    Holding,
+    Landed,
+    Cancelled,
+    Diverted
+};
+
+const char *flightStatusName(FlightStatus status);
+
+// Per-flight state, kept small so a day's schedule stays in cache: routes
+// live in a shared pool and the record holds an offset into it.
+struct FlightRecord
+{
+    std::int32_t src;
+    std::int32_t dst;
+    std::uint32_t scheduledDeparture;
+    std::uint32_t departure = 0;
+    std::uint32_t arrival = 0;
+    std::uint32_t routeOffset = 0;
+    std::uint16_t routeLength = 0;
+    std::uint16_t leg = 0;
+    // Time the current leg (or the turn back) began, or holding started.
+    std::uint32_t legStart = 0;
+    // Bumped whenever a scheduled arrival is superseded.
+    std::uint32_t generation = 0;
+    // Weather epoch the route was planned in.
+    std::uint32_t planEpoch = 0;
+    // Index in the airborne list of the current leg.
+    std::uint32_t legSlot = 0;
+    // Clear-weather route length, fixed at the first departure attempt.
+    float nominalDistance = -1;
+    float distanceFlown = 0;
+    std::uint16_t reroutes = 0;
+    FlightStatus status = FlightStatus::Scheduled;
+};
+
+struct EventSimStats
+{
+    std::uint64_t events = 0;
+    std::uint64_t searches = 0;
+    std::uint64_t reroutes = 0;
+    std::uint64_t turnBacks = 0;
+    std::uint64_t holds = 0;
+    std::uint64_t stormsStarted = 0;
+};
+
+class EventSimulation
+{
+public:
+    // Simulates on a private copy of `graph`; its weather is the starting
+    // weather.
+    EventSimulation(const FlightGraph &graph, EventSimOptions options = {});
+
+    // Both return an id; call them before run().
+    std::uint32_t addFlight(int src, int dst, std::uint32_t departure);
+    std::uint32_t addStorm(int u, int v, std::uint32_t start, std::uint32_t end);
+
+    // Processes every event up to and including `until`.
+    void run(std::uint32_t until = UINT32_MAX);
+
+    std::uint32_t now() const { return static_cast<std::uint32_t>(wheel.now()); }
+    const std::vector<FlightRecord> &flights() const { return records; }
+    const EventSimStats &stats() const { return counters; }
+    const FlightGraph &network() const { return graph; }
+
+    // Arrival minus (scheduled departure + clear-weather block time), in
+    // seconds, for landed flights.
+    std::int64_t arrivalDelay(const FlightRecord &flight) const;
+
+    // Writes one CSV line per flight.
+    bool writeOutcomes(const std::string &path) const;
+
+private:
+    enum EventKind : std::uint32_t
+    {
+        Depart,
+        Arrive,
+        ReturnArrive,
+        Retry,
+        StormStart,
+        StormEnd
+    };
+
+    struct Event
+    {
+        EventKind kind;
+        std::uint32_t id;
+        std::uint32_t generation;
+    };
+
+    struct Storm
+    {
+        int u;
+        int v;
+    };
+
+    void fire(const Event &event);
+    void depart(std::uint32_t id);
+    void arrive(std::uint32_t id);
+    void returnArrive(std::uint32_t id);
+    void startStorm(std::uint32_t id);
+    void endStorm(std::uint32_t id);
+
+    // Flies on from the flight's current waypoint, re-planning first if
+    // `force` or the rest of its route crosses bad weather.
+    void continueFrom(std::uint32_t id, bool force);
+    bool plan(FlightRecord &flight, int from);
+    void startLeg(std::uint32_t id);
+    void hold(std::uint32_t id);
+    void turnBack(std::uint32_t id);
+    void leaveLeg(std::uint32_t id);
+
+    int node(const FlightRecord &flight, int i) const { return routes[flight.routeOffset + i]; }
+    std::uint32_t edgeIndex(int u, int v) const { return std::uint32_t(u) * graph.airports.size() + v; }
+    std::uint32_t secondsFor(double distance) const;
+
+    FlightGraph graph;
+    EventSimOptions options;
+    TimingWheel<Event> wheel;
+    SearchWorkspace workspace;
+    std::vector<FlightRecord> records;
+    std::vector<std::int32_t> routes;
+    std::vector<Storm> storms;
+    // Flights currently flying each directed leg, for storms to turn back.
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> airborne;
+    std::unordered_map<std::uint32_t, int> activeStorms;
+    std::uint32_t epoch = 0;
+    StrId stormDescription;
+    StrId clearDescription;
+    EventSimStats counters;
+};
+
+#endif
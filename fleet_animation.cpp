@@ -0,0 +1,90 @@
+#include "fleet_animation.h"
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+int FleetAnimation::addFlight(const vector<Vec2> &route, float flightSpeed, float phase)
+{
+    if (route.size() < 2)
+    return -1;
+
+    uint32_t start = pointX.size();
+    float total = 0;
+    for (size_t i = 0; i < route.size(); ++i)
+    {
+        if (i > 0)
+        {
+            float dx = route[i].x - route[i - 1].x;
+            float dy = route[i].y - route[i - 1].y;
+            float segmentLength = sqrt(dx * dx + dy * dy);
+            total += segmentLength;
+            segmentDirX.push_back(segmentLength > 0 ? dx / segmentLength : 1);
+            segmentDirY.push_back(segmentLength > 0 ? dy / segmentLength : 0);
+        }
+        pointX.push_back(route[i].x);
+        pointY.push_back(route[i].y);
+        cumulative.push_back(total);
+    }
+    // One direction per waypoint keeps indices aligned with the points; the
+    // entry for the last waypoint is never read.
+    segmentDirX.push_back(0);
+    segmentDirY.push_back(0);
+
+    if (total <= 0)
+    {
+        pointX.resize(start);
+        pointY.resize(start);
+        cumulative.resize(start);
+        segmentDirX.resize(start);
+        segmentDirY.resize(start);
+        return -1;
+    }
+
+    routeStart.push_back(start);
+    routePoints.push_back(route.size());
+    length.push_back(total);
+    distance.push_back(min(max(phase, 0.0f), 1.0f) * total);
+    speed.push_back(flightSpeed);
+    segment.push_back(0);
+    posX.push_back(route[0].x);
+    posY.push_back(route[0].y);
+    dirX.push_back(segmentDirX[start]);
+    dirY.push_back(segmentDirY[start]);
+    return static_cast<int>(distance.size() - 1);
+}
+
+void FleetAnimation::update(float seconds)
+{
+    size_t n = distance.size();
+    float *d = distance.data();
+    const float *v = speed.data();
+    const float *total = length.data();
+
+    // Advance and wrap, branch-free so it vectorizes.
+    for (size_t i = 0; i < n; ++i)
+    {
+        float next = d[i] + v[i] * seconds;
+        d[i] = next - total[i] * floor(next / total[i]);
+    }
+
+    // Segment lookup: the last waypoint whose prefix sum is <= distance.
+    for (size_t i = 0; i < n; ++i)
+    {
+        const float *first = cumulative.data() + routeStart[i];
+        const float *last = first + routePoints[i] - 1;
+        const float *at = upper_bound(first, last, d[i]);
+        segment[i] = routeStart[i] + static_cast<uint32_t>(max<ptrdiff_t>(at - first - 1, 0));
+    }
+
+    // Interpolate along the segment.
+    const float *cum = cumulative.data();
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint32_t k = segment[i];
+        float along = d[i] - cum[k];
+        posX[i] = pointX[k] + segmentDirX[k] * along;
+        posY[i] = pointY[k] + segmentDirY[k] * along;
+        dirX[i] = segmentDirX[k];
+        dirY[i] = segmentDirY[k];
+    }
+}
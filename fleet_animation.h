@@ -0,0 +1,52 @@
+#ifndef FLEET_ANIMATION_H
+#define FLEET_ANIMATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "flight_graph.h"
+
+// Positions of many aircraft flying their routes on a loop, for drawing
+// thousands of flights at once. Each route is stored once as its waypoints
+// plus the prefix sums of its segment lengths, so placing an aircraft is a
+// binary search for its segment. Per-aircraft state is kept as separate
+// arrays (structure of arrays) and update() runs over them in plain loops
+// the compiler can vectorize.
+class FleetAnimation
+{
+public:
+    // Adds an aircraft flying `route` (at least two waypoints) at `speed`
+    // map units per second, starting `phase` (0..1) of the way along it.
+    // Returns its index, or -1 for a route with no length.
+    int addFlight(const std::vector<Vec2> &route, float speed, float phase = 0);
+
+    // Advances every aircraft by `seconds`, wrapping back to the start of
+    // its route at the end, and recomputes positions and headings.
+    void update(float seconds);
+
+    std::size_t size() const { return distance.size(); }
+
+    // Position and unit heading of each aircraft as of the last update().
+    const std::vector<float> &x() const { return posX; }
+    const std::vector<float> &y() const { return posY; }
+    const std::vector<float> &headingX() const { return dirX; }
+    const std::vector<float> &headingY() const { return dirY; }
+
+private:
+    // Route storage shared by all aircraft: waypoints, the prefix sum of
+    // segment lengths at each waypoint, and each segment's unit direction.
+    std::vector<float> pointX, pointY;
+    std::vector<float> cumulative;
+    std::vector<float> segmentDirX, segmentDirY;
+
+    // Per aircraft.
+    std::vector<std::uint32_t> routeStart;
+    std::vector<std::uint32_t> routePoints;
+    std::vector<float> length;
+    std::vector<float> distance;
+    std::vector<float> speed;
+    std::vector<std::uint32_t> segment;
+    std::vector<float> posX, posY, dirX, dirY;
+};
+
+#endif
@@ -6,6 +6,8 @@
 #include <random>
 #include <chrono>
 #include <sstream>
+#include <thread>
+#include "sim_channel.h"
 using namespace std;
 
 struct Airport
@@ -311,6 +313,35 @@ int resolveAirportIndex(const string &input, const vector<Airport> &airports)
     return -1;
 }
 
+struct PendingWeather
+{
+    int u;
+    int v;
+    bool isBad;
+    string description;
+};
+
+// Starts the resident simulator in the background and waits until its
+// channel accepts messages.
+bool startSimulatorDaemon(SimChannel &channel)
+{
+#ifdef _WIN32
+    int result = system("start \"Flight Simulator\" flight_simulator.exe --daemon");
+#else
+    int result = system("./flight_simulator --daemon &");
+#endif
+    if (result != 0)
+    return false;
+
+    for (int attempt = 0; attempt < 100; ++attempt)
+    {
+        if (channel.open())
+        return true;
+        this_thread::sleep_for(chrono::milliseconds(50));
+    }
+    return false;
+}
+
 int main()
 {
     ios_base::sync_with_stdio(true);
@@ -385,6 +416,7 @@ int main()
     cout.flush();
     string updateWeather;
     cin >> updateWeather;
+    vector<PendingWeather> weatherUpdates;
 
     if (updateWeather == "y" || updateWeather == "Y")
     {
@@ -426,6 +458,14 @@ int main()
                 description = "Clear skies";
             }
 
+            if (a1 < 0 || static_cast<size_t>(a1) >= airports.size() || a2 < 0 ||
+                static_cast<size_t>(a2) >= airports.size() || a1 == a2)
+            {
+                cout << "Invalid airport pair. Update skipped." << endl;
+                continue;
+            }
+            weatherUpdates.push_back({a1, a2, condition == 1, description});
+
             cout << "Weather updated: "
                  << airports[a1].code << " to "
                  << airports[a2].code << " - "
@@ -440,10 +480,36 @@ int main()
     printLine('=');
     cout << "Starting flight simulation for " << ticket.departureAirport << " to " << ticket.arrivalAirport << "..." << endl;
 
-    string command = "flight_simulator.exe " + to_string(src) + " " + to_string(dst);
-    cout << "Running: " << command << endl;
+    SimChannel channel;
+    if (!channel.open())
+    {
+        cout << "Starting the resident flight simulator..." << endl;
+        startSimulatorDaemon(channel);
+    }
+
+    bool handedOff = false;
+    if (channel.isOpen())
+    {
+        auto start = chrono::steady_clock::now();
+        handedOff = true;
+        for (const auto &update : weatherUpdates)
+        handedOff = handedOff && channel.pushWeather(update.u, update.v, update.isBad, update.description);
+        handedOff = handedOff && channel.pushRoute(src, dst);
+        auto micros = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+        if (handedOff)
+        cout << "Handed off to the running simulator in " << micros << " us." << endl;
+    }
 
-    int result = system(command.c_str());
+    int result = 0;
+    if (!handedOff)
+    {
+        // No resident simulator: fall back to a one-shot process, which
+        // asks for weather again.
+        string command = "flight_simulator.exe " + to_string(src) + " " + to_string(dst);
+        cout << "Simulator daemon unavailable; weather updates will not carry over." << endl;
+        cout << "Running: " << command << endl;
+        result = system(command.c_str());
+    }
 
     if (result != 0)
     {
@@ -0,0 +1,251 @@
+#include "flight_graph.h"
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <random>
+using namespace std;
+
+FlightGraph::FlightGraph(size_t arenaBytes)
+    : arena(make_shared<pmr::monotonic_buffer_resource>(arenaBytes)),
+      strings(make_shared<StringPool>()),
+      clearWeather(strings->intern("Clear")),
+      airports(arena.get()),
+      adj(arena.get()),
+      pathAvailable(arena.get()),
+      pathWeather(arena.get())
+{
+}
+
+void FlightGraph::reserveAirports(size_t n)
+{
+    reservedAirports = n;
+    airports.reserve(n);
+    adj.reserve(n);
+    pathAvailable.reserve(n);
+    pathWeather.reserve(n);
+    for (auto &row : adj)
+    row.reserve(n);
+    for (auto &row : pathAvailable)
+    row.reserve(n);
+    for (auto &row : pathWeather)
+    row.reserve(n);
+}
+
+void FlightGraph::addAirport(string_view code, string_view name, float x, float y)
+{
+    airports.push_back({strings->intern(code), strings->intern(name), {x, y}});
+    size_t rowCapacity = max(reservedAirports, airports.size());
+
+    adj.emplace_back().reserve(rowCapacity);
+
+    for (auto &row : pathAvailable)
+    row.push_back(false);
+    pathAvailable.emplace_back().reserve(rowCapacity);
+    pathAvailable.back().resize(airports.size(), false);
+
+    for (auto &row : pathWeather)
+    row.push_back({false, clearWeather});
+    pathWeather.emplace_back().reserve(rowCapacity);
+    pathWeather.back().resize(airports.size(), {false, clearWeather});
+}
+
+void FlightGraph::addEdge(int u, int v, double dist)
+{
+    adj[u].emplace_back(v, dist);
+    adj[v].emplace_back(u, dist);
+    pathAvailable[u][v] = true;
+    pathAvailable[v][u] = true;
+    pathWeather[u][v] = {false, clearWeather};
+    pathWeather[v][u] = {false, clearWeather};
+}
+
+int FlightGraph::findAirport(string_view codeOrName) const
+{
+    StrId id;
+    if (!strings->find(codeOrName, id))
+    return -1;
+    for (size_t i = 0; i < airports.size(); ++i)
+    if (airports[i].code == id || airports[i].name == id)
+    return static_cast<int>(i);
+    return -1;
+}
+
+double FlightGraph::edgeLength(int u, int v) const
+{
+    for (auto [to, w] : adj[u])
+    if (to == v)
+    return w;
+    return numeric_limits<double>::infinity();
+}
+
+double FlightGraph::pathLength(const vector<int> &path) const
+{
+    double total = 0;
+    for (size_t i = 1; i < path.size(); ++i)
+    total += edgeLength(path[i - 1], path[i]);
+    return total;
+}
+
+bool FlightGraph::hasBadWeather(const vector<int> &path) const
+{
+    for (size_t i = 0; i < path.size() - 1; ++i)
+    {
+        int u = path[i];
+        int v = path[i + 1];
+        if (pathWeather[u][v].isBad)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+vector<pair<string, string>> FlightGraph::getPathWeatherInfo(const vector<int> &path) const
+{
+    vector<pair<string, string>> result;
+    for (size_t i = 0; i < path.size() - 1; ++i)
+    {
+        int u = path[i];
+        int v = path[i + 1];
+        if (pathWeather[u][v].isBad)
+        {
+            string segment = string(airportName(u)) + "-" + string(airportName(v));
+            result.push_back({segment, string(weatherDescription(u, v))});
+        }
+    }
+    return result;
+}
+
+vector<int> FlightGraph::dijkstra(int src, int dst) const
+{
+    return dijkstra(src, dst, [this](int u, int v) { return bool(pathAvailable[u][v]); });
+}
+
+int resolveAirportIndex(const string &input, const FlightGraph &graph)
+{
+    if (input.empty() || !isdigit(static_cast<unsigned char>(input[0])))
+    return graph.findAirport(input);
+    // Input from clients and feeds: anything starting with a digit must be a
+    // whole, in-range index, so overflow and trailing junk are rejected
+    // rather than thrown or ignored.
+    int index = -1;
+    const char *end = input.data() + input.size();
+    auto [parsed, error] = from_chars(input.data(), end, index);
+    if (error != errc() || parsed != end || index < 0 || index >= static_cast<int>(graph.airports.size()))
+    return -1;
+    return index;
+}
+
+void appendRouteLine(string &out, const FlightGraph &graph, int src, int dst, const RoutePlan &plan)
+{
+    out += graph.airportCode(src);
+    out += ' ';
+    out += graph.airportCode(dst);
+    if (plan.finalPath.empty())
+    {
+        out += " none\n";
+        return;
+    }
+
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), " ok %.2f rerouted=%d", plan.distance, plan.rerouted ? 1 : 0);
+    out += buffer;
+    for (int idx : plan.finalPath)
+    {
+        out += ' ';
+        out += graph.airportCode(idx);
+    }
+    out += '\n';
+}
+
+void buildDefaultNetwork(FlightGraph &graph)
+{
+    TRACE_SCOPE("buildDefaultNetwork");
+    graph.reserveAirports(15);
+    graph.addAirport("JFK", "John F. Kennedy International Airport (New York)", 150, 100);
+    graph.addAirport("LAX", "Los Angeles International Airport (Los Angeles)", 50, 500);
+    graph.addAirport("ORD", "O'Hare International Airport (Chicago)", 350, 150);
+    graph.addAirport("DFW", "Dallas/Fort Worth International Airport (Dallas–Fort Worth)", 450, 350);
+    graph.addAirport("ATL", "Hartsfield–Jackson Atlanta International Airport (Atlanta)", 300, 300);
+    graph.addAirport("SFO", "San Francisco International Airport (San Francisco)", 100, 450);
+    graph.addAirport("MIA", "Miami International Airport (Miami)", 250, 550);
+    graph.addAirport("SEA", "Seattle–Tacoma International Airport (Seattle)", 50, 50);
+    graph.addAirport("DEN", "Denver International Airport (Denver)", 300, 200);
+    graph.addAirport("BOS", "Logan International Airport (Boston)", 200, 80);
+    graph.addAirport("LAS", "Harry Reid International Airport (Las Vegas) (formerly McCarran)", 150, 450);
+    graph.addAirport("PHX", "Phoenix Sky Harbor International Airport (Phoenix)", 350, 450);
+    graph.addAirport("IAH", "George Bush Intercontinental Airport (Houston)", 500, 400);
+    graph.addAirport("EWR", "Newark Liberty International Airport (Newark)", 180, 90);
+    graph.addAirport("CLT", "Charlotte Douglas International Airport (Charlotte)", 330, 280);
+
+    int n = graph.airports.size();
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = i + 1; j < n; ++j)
+        {
+            const auto &pi = graph.airports[i].position;
+            const auto &pj = graph.airports[j].position;
+            double dx = pi.x - pj.x;
+            double dy = pi.y - pj.y;
+            double dist = sqrt(dx * dx + dy * dy);
+            graph.addEdge(i, j, dist);
+        }
+    }
+}
+
+void buildRandomNetwork(FlightGraph &graph, int airports, int degree, unsigned seed, float width, float height)
+{
+    TRACE_SCOPE("buildRandomNetwork");
+    mt19937 rng(seed);
+    uniform_real_distribution<float> x(0, width), y(0, height);
+    graph.reserveAirports(airports);
+    char code[16];
+    for (int i = 0; i < airports; ++i)
+    {
+        snprintf(code, sizeof(code), "R%04d", i);
+        graph.addAirport(code, code, x(rng), y(rng));
+    }
+
+    // Bucket airports into cells holding about `degree` each, then take the
+    // nearest neighbours from a widening ring of cells around each airport.
+    int cells = max(1, static_cast<int>(sqrt(double(airports) / max(degree, 1))));
+    vector<vector<int>> bucket(size_t(cells) * cells);
+    auto cellX = [&](int i) { return min(cells - 1, static_cast<int>(graph.airports[i].position.x / width * cells)); };
+    auto cellY = [&](int i) { return min(cells - 1, static_cast<int>(graph.airports[i].position.y / height * cells)); };
+    for (int i = 0; i < airports; ++i)
+    bucket[size_t(cellY(i)) * cells + cellX(i)].push_back(i);
+
+    auto distance = [&](int u, int v)
+    {
+        return hypot(double(graph.airports[u].position.x - graph.airports[v].position.x),
+                     double(graph.airports[u].position.y - graph.airports[v].position.y));
+    };
+    vector<pair<double, int>> candidates;
+    for (int u = 0; u < airports; ++u)
+    {
+        candidates.clear();
+        int cx = cellX(u), cy = cellY(u);
+        // One ring beyond the first that yields enough candidates, since a
+        // nearer airport can sit just across a cell boundary.
+        for (int ring = 0, extra = 1; ring <= cells && extra >= 0; ++ring)
+        {
+            for (int yy = max(0, cy - ring); yy <= min(cells - 1, cy + ring); ++yy)
+            for (int xx = max(0, cx - ring); xx <= min(cells - 1, cx + ring); ++xx)
+            {
+                if (max(abs(xx - cx), abs(yy - cy)) != ring)
+                continue;
+                for (int v : bucket[size_t(yy) * cells + xx])
+                if (v != u)
+                candidates.push_back({distance(u, v), v});
+            }
+            if (static_cast<int>(candidates.size()) >= degree)
+            --extra;
+        }
+        int keep = min<int>(degree, candidates.size());
+        partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end());
+        for (int k = 0; k < keep; ++k)
+        if (!graph.available(u, candidates[k].second))
+        graph.addEdge(u, candidates[k].second, candidates[k].first);
+    }
+}
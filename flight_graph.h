@@ -0,0 +1,294 @@
+#ifndef FLIGHT_GRAPH_H
+#define FLIGHT_GRAPH_H
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "graph_core.h"
+#include "routing_stats.h"
+#include "search_trace.h"
+#include "string_pool.h"
+#include "trace.h"
+
+// Map position of an airport. Kept free of any graphics types so the routing
+// core can be built and run without SFML.
+struct Vec2
+{
+    float x;
+    float y;
+};
+
+struct Airport
+{
+    StrId code;
+    StrId name;
+    Vec2 position;
+};
+
+struct WeatherCondition
+{
+    bool isBad;
+    StrId description;
+};
+
+struct WeatherUpdate
+{
+    int u;
+    int v;
+    bool isBad;
+    std::string description;
+};
+
+// Scratch buffers for one search. Keep one per thread and pass it to the
+// dijkstra()/planRoute() overloads that take it.
+struct SearchWorkspace : SearchBuffers
+{
+    // Optional; when set, dijkstra() records its steps here.
+    SearchTrace *trace = nullptr;
+    // Nodes the last search took off its queue, the target included.
+    // Always counted, unlike `counters`.
+    std::size_t settled = 0;
+#if ROUTING_STATS
+    SearchCounters counters;
+#endif
+};
+
+// Feeds bestFirstSearch()'s events to a workspace's counters and, when
+// Traced, to its trace.
+template <bool Traced>
+struct WorkspaceHooks
+{
+    SearchWorkspace &ws;
+
+    void settle(int node, int parent)
+    {
+        ++ws.settled;
+        ROUTING_COUNT(ws, settled);
+        if constexpr (Traced)
+        ws.trace->settle(node, parent);
+    }
+
+    void found(int node, int parent)
+    {
+        ++ws.settled;
+        if constexpr (Traced)
+        ws.trace->settle(node, parent);
+    }
+
+    void stalePop() { ROUTING_COUNT(ws, stalePops); }
+
+    void blocked(int node, int from)
+    {
+        ROUTING_COUNT(ws, edgesSkipped);
+        if constexpr (Traced)
+        ws.trace->blocked(node, from);
+    }
+
+    void relax(int node, int from)
+    {
+        ROUTING_COUNT(ws, heapPushes);
+        if constexpr (Traced)
+        ws.trace->relax(node, from);
+    }
+};
+
+// Rows are allocated from `arena`, which only the graph that created it
+// allocates from. A copy puts its rows on the default (global) heap, so it
+// can be modified on another thread and freed on its own, but shares
+// `strings` with the original: StrIds stay valid across copies, and only
+// one of them may intern at a time.
+struct FlightGraph
+{
+    std::shared_ptr<std::pmr::monotonic_buffer_resource> arena;
+    std::shared_ptr<StringPool> strings;
+    StrId clearWeather;
+    std::size_t reservedAirports = 0;
+
+    std::pmr::vector<Airport> airports;
+    std::pmr::vector<std::pmr::vector<std::pair<int, double>>> adj;
+    std::pmr::vector<std::pmr::vector<bool>> pathAvailable;
+    std::pmr::vector<std::pmr::vector<WeatherCondition>> pathWeather;
+
+    explicit FlightGraph(std::size_t arenaBytes = 64 * 1024);
+
+    // Sizes every per-airport row up front so that building a graph of `n`
+    // airports never regrows a row inside the arena.
+    void reserveAirports(std::size_t n);
+
+    void addAirport(std::string_view code, std::string_view name, float x, float y);
+    void addEdge(int u, int v, double dist);
+
+    void updateWeather(int u, int v, bool isBad, StrId description)
+    {
+        pathWeather[u][v] = {isBad, description};
+        pathWeather[v][u] = {isBad, description};
+        pathAvailable[u][v] = !isBad;
+        pathAvailable[v][u] = !isBad;
+    }
+
+    void updateWeather(int u, int v, bool isBad, std::string_view description)
+    {
+        updateWeather(u, v, isBad, strings->intern(description));
+    }
+
+    // Applies a batch of updates in a single pass.
+    void applyWeather(const std::vector<WeatherUpdate> &batch)
+    {
+        for (const auto &update : batch)
+        updateWeather(update.u, update.v, update.isBad, update.description);
+    }
+
+    std::string_view airportCode(int i) const { return strings->view(airports[i].code); }
+    std::string_view airportName(int i) const { return strings->view(airports[i].name); }
+    std::string_view weatherDescription(int u, int v) const { return strings->view(pathWeather[u][v].description); }
+    bool available(int u, int v) const { return pathAvailable[u][v]; }
+    bool isBad(int u, int v) const { return pathWeather[u][v].isBad; }
+
+    int findAirport(std::string_view codeOrName) const;
+    double edgeLength(int u, int v) const;
+    double pathLength(const std::vector<int> &path) const;
+
+    bool hasBadWeather(const std::vector<int> &path) const;
+    std::vector<std::pair<std::string, std::string>> getPathWeatherInfo(const std::vector<int> &path) const;
+
+    std::vector<int> dijkstra(int src, int dst) const;
+
+    // Searches with edge availability supplied by the caller, e.g. from a
+    // pinned WeatherSnapshot instead of this graph's own pathAvailable.
+    template <typename Available>
+    std::vector<int> dijkstra(int src, int dst, const Available &available) const
+    {
+        SearchWorkspace workspace;
+        return dijkstra(src, dst, available, workspace);
+    }
+
+    // Same search, reusing the caller's buffers. Only the entries a search
+    // touches are reset afterwards, so a long-lived workspace makes repeated
+    // queries allocation-free.
+    template <typename Available>
+    std::vector<int> dijkstra(int src, int dst, const Available &available, SearchWorkspace &ws) const
+    {
+        TRACE_SCOPE("dijkstra");
+        if (ws.trace)
+        return search<true>(src, dst, available, ws);
+        return search<false>(src, dst, available, ws);
+    }
+
+private:
+    // The traced and untraced searches are separate instantiations, so
+    // recording costs nothing when no trace is attached.
+    template <bool Traced, typename Available>
+    std::vector<int> search(int src, int dst, const Available &available, SearchWorkspace &ws) const
+    {
+        ws.settled = 0;
+        ROUTING_RESET_COUNTERS(ws);
+        if constexpr (Traced)
+        ws.trace->begin(src, dst);
+        WorkspaceHooks<Traced> hooks{ws};
+        bestFirstSearch(adj, src, dst, available, ZeroHeuristic(), ws, hooks);
+        std::vector<int> path = searchPath(ws, src, dst);
+        ws.reset();
+        return path;
+    }
+};
+
+// One flag per entry of graph.adj, in order: whether a search may use it.
+// Lets analyses that run many searches evaluate the weather once.
+template <typename Available>
+std::vector<char> usableArcs(const FlightGraph &graph, const Available &available)
+{
+    std::vector<char> usable;
+    for (int u = 0; u < static_cast<int>(graph.adj.size()); ++u)
+    for (auto [v, w] : graph.adj[u])
+    usable.push_back(available(u, v) ? 1 : 0);
+    return usable;
+}
+
+struct RoutePlan
+{
+    std::vector<int> directPath;
+    std::vector<int> finalPath;
+    std::vector<std::pair<std::string, std::string>> badWeatherSegments;
+    double distance = 0;
+    bool rerouted = false;
+};
+
+// Shortest route from src to dst given the weather in `weather` (the graph
+// itself or a pinned WeatherSnapshot). The direct route ignores weather and
+// is only used to report which of its segments are affected; the final
+// route avoids every bad-weather segment.
+//
+// `search(available)` runs one src -> dst search; `ws` is the workspace it
+// counts into.
+template <typename Weather, typename Search>
+RoutePlan planRouteWith(const FlightGraph &graph, const Weather &weather, [[maybe_unused]] SearchWorkspace &ws,
+                        Search &&search)
+{
+    TRACE_SCOPE("planRoute");
+    RoutePlan plan;
+    ROUTING_TIMER(timer);
+    plan.directPath = search([](int, int) { return true; });
+    ROUTING_RECORD(timer, QueryType::Direct, ws);
+    std::vector<int> weatherAwarePath = search([&](int u, int v)
+    { return weather.available(u, v) && !weather.isBad(u, v); });
+    ROUTING_RECORD(timer, weatherAwarePath == plan.directPath ? QueryType::WeatherAware : QueryType::Reroute, ws);
+
+    for (std::size_t i = 1; i < plan.directPath.size(); ++i)
+    {
+        int u = plan.directPath[i - 1];
+        int v = plan.directPath[i];
+        if (weather.isBad(u, v))
+        {
+            std::string segment = std::string(graph.airportName(u)) + "-" + std::string(graph.airportName(v));
+            plan.badWeatherSegments.push_back({segment, std::string(weather.weatherDescription(u, v))});
+        }
+    }
+
+    plan.finalPath = std::move(weatherAwarePath);
+    plan.distance = graph.pathLength(plan.finalPath);
+    plan.rerouted = !plan.finalPath.empty() && !plan.badWeatherSegments.empty() && plan.finalPath != plan.directPath;
+    return plan;
+}
+
+template <typename Weather>
+RoutePlan planRoute(const FlightGraph &graph, const Weather &weather, int src, int dst, SearchWorkspace &ws)
+{
+    return planRouteWith(graph, weather, ws,
+                         [&](const auto &available) { return graph.dijkstra(src, dst, available, ws); });
+}
+
+template <typename Weather>
+RoutePlan planRoute(const FlightGraph &graph, const Weather &weather, int src, int dst)
+{
+    SearchWorkspace workspace;
+    return planRoute(graph, weather, src, dst, workspace);
+}
+
+// Accepts an airport index, IATA code or full name; returns -1 if unknown
+// or out of range.
+int resolveAirportIndex(const std::string &input, const FlightGraph &graph);
+
+// Appends "<SRC> <DST> ok <distance> rerouted=<0|1> <CODE>..." (or
+// "<SRC> <DST> none") and a newline: the result line shared by the batch
+// CLI and the route server.
+void appendRouteLine(std::string &out, const FlightGraph &graph, int src, int dst, const RoutePlan &plan);
+
+// Builds the fifteen-airport network shown by the simulator, with an edge
+// between every pair of airports weighted by map distance.
+void buildDefaultNetwork(FlightGraph &graph);
+
+// Builds `airports` airports at random positions in a width x height map,
+// each linked to its `degree` nearest neighbours (so some have more links),
+// for exercising the renderer and searches at scale. FlightGraph keeps
+// n x n weather tables, so a few thousand airports is the practical limit.
+void buildRandomNetwork(FlightGraph &graph, int airports, int degree = 6, unsigned seed = 1, float width = 900,
+                        float height = 650);
+
+#endif
@@ -1,170 +1,30 @@
 #include <SFML/Graphics.hpp>
 #include <iostream>
 #include <vector>
-#include <queue>
 #include <limits>
 #include <cmath>
 #include <algorithm>
 #include <string>
 #include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <ctime>
 #include <random>
 #include <chrono>
 #include <sstream>
+#include <memory>
+#include <future>
+#include "betweenness.h"
+#include "fleet_animation.h"
+#include "flight_graph.h"
+#include "map_view.h"
+#include "route_worker.h"
+#include "search_trace.h"
+#include "sim_channel.h"
+#include "trace.h"
 using namespace std;
 
-struct Airport
-{
-    string code;
-    sf::Vector2f position;
-};
-
-struct WeatherCondition
-{
-    bool isBad;
-    string description;
-};
-
-struct FlightGraph
-{
-    vector<Airport> airports;
-    vector<vector<pair<int, double>>> adj;
-    vector<vector<bool>> pathAvailable;
-    vector<vector<WeatherCondition>> pathWeather;
-
-    void addAirport(const string &code, float x, float y)
-    {
-        airports.push_back({code, {x, y}});
-        adj.emplace_back();
-
-        for (auto &row : pathAvailable)
-        row.push_back(false);
-        pathAvailable.push_back(vector<bool>(airports.size(), false));
-
-        for (auto &row : pathWeather)
-        row.push_back({false, "Clear"});
-        pathWeather.push_back(vector<WeatherCondition>(airports.size(), {false, "Clear"}));
-    }
-
-    void addEdge(int u, int v, double dist)
-    {
-        adj[u].emplace_back(v, dist);
-        adj[v].emplace_back(u, dist);
-        pathAvailable[u][v] = true;
-        pathAvailable[v][u] = true;
-        pathWeather[u][v] = {false, "Clear"};
-        pathWeather[v][u] = {false, "Clear"};
-    }
-
-    void updateWeather(int u, int v, bool isBad, const string &description)
-    {
-        pathWeather[u][v] = {isBad, description};
-        pathWeather[v][u] = {isBad, description};
-        pathAvailable[u][v] = !isBad;
-        pathAvailable[v][u] = !isBad;
-    }
-
-    bool hasBadWeather(const vector<int> &path) const
-    {
-        for (size_t i = 0; i < path.size() - 1; ++i)
-        {
-            int u = path[i];
-            int v = path[i + 1];
-            if (pathWeather[u][v].isBad)
-            {
-                return true;
-            }
-        }
-        return false;
-    }
-
-    vector<pair<string, string>> getPathWeatherInfo(const vector<int> &path) const
-    {
-        vector<pair<string, string>> result;
-        for (size_t i = 0; i < path.size() - 1; ++i)
-        {
-            int u = path[i];
-            int v = path[i + 1];
-            if (pathWeather[u][v].isBad)
-            {
-                result.push_back({airports[u].code + "-" + airports[v].code, pathWeather[u][v].description});
-            }
-        }
-        return result;
-    }
-
-    vector<int> dijkstra(int src, int dst) const
-    {
-        int n = adj.size();
-        vector<double> dist(n, numeric_limits<double>::infinity());
-        vector<int> prev(n, -1);
-        dist[src] = 0;
-
-        using PDI = pair<double, int>;
-        priority_queue<PDI, vector<PDI>, greater<>> pq;
-        pq.push({0, src});
-
-        while (!pq.empty())
-        {
-            auto [d, u] = pq.top();
-            pq.pop();
-            if (u == dst)
-                break;
-
-            for (auto [v, w] : adj[u])
-            {
-                if (!pathAvailable[u][v])
-                    continue;
-
-                double alt = d + w;
-                if (alt < dist[v])
-                {
-                    dist[v] = alt;
-                    prev[v] = u;
-                    pq.push({alt, v});
-                }
-            }
-        }
-
-        vector<int> path;
-        for (int at = dst; at != -1; at = prev[at])
-        path.push_back(at);
-        reverse(path.begin(), path.end());
-
-        if (path.empty() || path.front() != src)
-        return {};
-        return path;
-    }
-
-    vector<int> findRouteWithWeatherRerouting(int src, int dst, bool &rerouted)
-    {
-        vector<int> originalPath = dijkstra(src, dst);
-        if (originalPath.empty() || !hasBadWeather(originalPath))
-        {
-            rerouted = false;
-            return originalPath;
-        }
-
-        rerouted = true;
-
-        FlightGraph tempGraph = *this;
-
-        for (size_t i = 0; i < originalPath.size() - 1; ++i)
-        {
-            int u = originalPath[i];
-            int v = originalPath[i + 1];
-            if (pathWeather[u][v].isBad)
-            {
-
-                tempGraph.pathAvailable[u][v] = false;
-                tempGraph.pathAvailable[v][u] = false;
-            }
-        }
-        return tempGraph.dijkstra(src, dst);
-    }
-};
-
 struct FlightTicket
 {
     int departureAirportIndex;
@@ -260,67 +120,178 @@ void printLine(char c = '-', int length = 50)
     cout << endl;
 }
 
-int resolveAirportIndex(const string &input, const vector<Airport> &airports)
+void reportRoute(const FlightGraph &graph, const RoutePlan &plan)
 {
-    if (isdigit(input[0]))
-    return stoi(input);
-    for (size_t i = 0; i < airports.size(); ++i)
-    if (airports[i].code == input)
-    return static_cast<int>(i);
-    return -1;
+    const vector<int> &finalPath = plan.finalPath;
+
+    if (finalPath.empty())
+    {
+        cout << "No path found between the selected airports due to weather conditions.\n";
+    }
+    else if (!plan.badWeatherSegments.empty())
+    {
+        cout << "\nBAD WEATHER DETECTED on the direct route!\n";
+        cout << "Affected segments:\n";
+        for (const auto &segment : plan.badWeatherSegments)
+        {
+            cout << "  " << segment.first << ": " << segment.second << "\n";
+        }
+        cout << "Automatically rerouted to avoid bad weather.\n";
+
+        cout << "New route: ";
+        for (int idx : finalPath)
+        cout << graph.airportName(idx) << " ";
+        cout << "\n";
+    }
+    else
+    {
+        cout << "Route has good weather conditions.\n";
+
+        cout << "Shortest path: ";
+        for (int idx : finalPath)
+        cout << graph.airportName(idx) << " ";
+        cout << "\n";
+    }
 }
 
-void visualizeGraph(const FlightGraph &graph, const vector<int> &path, bool rerouted = false)
+// Plans src -> dst on a RouteWorker while the window is already open, plays
+// back the search that found it and then animates the flight. Right-clicking
+// a route toggles bad weather on it: `graph` and the map change at once and
+// the worker replans in the background, so the window keeps responding
+// however long the search takes and the new route appears when it is ready.
+// B shows a heatmap of the segments carrying the most shortest routes
+// (edge betweenness under the current weather), computed on its own thread.
+void visualizeGraph(FlightGraph &graph, const sf::Font &font, int src, int dst)
 {
-    sf::RenderWindow window(sf::VideoMode(900, 650), "Flight Path Visualization");
-    window.setFramerateLimit(60);
+    // The worker shares the graph's string pool and must only read it, so
+    // the description is interned before it starts.
+    const StrId mapStorm = graph.strings->intern("Storm (set on map)");
+    RouteWorker worker(graph);
+    worker.requestRoute(src, dst);
 
-    sf::Font font;
-    if (!font.loadFromFile("default.ttf"))
+    sf::RenderWindow window;
     {
-        cerr << "Error loading font 'default.ttf'. Make sure it's available.\n";
-        return;
+        TRACE_SCOPE_CAT("createWindow", "sfml");
+        window.create(sf::VideoMode(900, 650), "Flight Path Visualization");
     }
+    window.setFramerateLimit(60);
 
-    sf::Color availableColor = sf::Color(100, 255, 100);
     sf::Color unavailableColor = sf::Color(255, 80, 80);
     sf::Color airportColor = sf::Color(50, 120, 250);
     sf::Color pathColor = sf::Color::Yellow;
     sf::Color reroutedPathColor = sf::Color(255, 165, 0);
     sf::Color planeColor = sf::Color::White;
     sf::Color waypointColor = sf::Color::Magenta;
-    sf::Color badWeatherColor = sf::Color(255, 0, 0, 128);
+    sf::Color frontierColor = sf::Color(255, 200, 60);
+    sf::Color settledColor = sf::Color(0, 220, 220);
 
-    cout << "\nVisualizing path: ";
-    for (int idx : path)
-    {
-        cout << graph.airports[idx].code << " ";
-    }
-    cout << "\n";
+    NetworkBatch network(graph, airportColor);
+    LabelLayer labels(font);
+    labelAirports(labels, graph, true);
 
-    vector<sf::CircleShape> airportShapes;
-    vector<sf::Text> airportLabels;
+    sf::Text statusText;
+    statusText.setFont(font);
+    statusText.setString("PLANNING ROUTE...");
+    statusText.setFillColor(sf::Color::White);
+    statusText.setCharacterSize(18);
+    statusText.setPosition(20, 20);
 
-    for (size_t i = 0; i < graph.airports.size(); ++i)
-    {
-        const auto &airport = graph.airports[i];
-        sf::CircleShape shape(8);
-        shape.setFillColor(airportColor);
-        shape.setPosition(airport.position);
-        airportShapes.push_back(shape);
-
-        sf::Text label;
-        label.setFont(font);
-        label.setString(airport.code);
-        label.setCharacterSize(14);
-        label.setFillColor(sf::Color::White);
-        label.setPosition(airport.position.x + 12, airport.position.y - 5);
-        airportLabels.push_back(label);
-    }
+    sf::Text pathText;
+    pathText.setFont(font);
+    pathText.setCharacterSize(16);
+    pathText.setFillColor(sf::Color::White);
+    pathText.setPosition(20, 50);
 
+    sf::Text heatText;
+    heatText.setFont(font);
+    heatText.setCharacterSize(14);
+    heatText.setFillColor(sf::Color::White);
+    heatText.setPosition(20, 140);
+
+    // Critical-segment heatmap. The analysis reads only the graph topology,
+    // which never changes here, plus a copy of which segments are open.
+    bool showHeat = false;
+    bool heatStale = false;
+    future<vector<EdgeBetweenness>> heatJob;
+    auto startHeatJob = [&]()
+    {
+        BetweennessOptions options;
+        // Sampling keeps the wait short on large maps.
+        if (graph.airports.size() > 1000)
+        options.samples = 256;
+        vector<char> usable = usableArcs(graph, [&](int u, int v) { return graph.available(u, v) && !graph.isBad(u, v); });
+        heatJob = async(launch::async, [&graph, usable = move(usable), options]
+                        { return edgeBetweenness(graph, usable, options); });
+        heatStale = false;
+        heatText.setString("Critical segments: computing...");
+    };
+
+    sf::Text workerText;
+    workerText.setFont(font);
+    workerText.setCharacterSize(14);
+    workerText.setFillColor(sf::Color::White);
+    workerText.setPosition(20, 120);
+
+    // The route on show, replaced whenever the worker publishes a plan.
+    vector<int> path;
     vector<sf::CircleShape> pathAirportShapes;
-    if (!path.empty())
+    vector<sf::VertexArray> pathSegments;
+    vector<float> pathLengths;
+    // pathStarts[i]: distance along the route where segment i begins.
+    vector<float> pathStarts;
+    float totalPathLength = 0.0f;
+
+    sf::Clock clock;
+    float animationProgress = 0.0f;
+    const float animationSpeed = 0.3f;
+    bool flightPaused = false;
+
+    sf::CircleShape airplane(6, 3);
+    airplane.setFillColor(planeColor);
+    airplane.setOrigin(6, 6);
+
+    // Search playback: Space pauses, Up/Down double or halve the speed,
+    // Left/Right step while paused, R restarts. The flight animation starts
+    // once the playback has finished; after that Space pauses the flight.
+    // Only a newly requested route is played back; a reroute after a
+    // weather edit is shown straight away.
+    unique_ptr<SearchReplay> replay;
+    double eventsPerSecond = 0;
+    double replayBudget = 0;
+    bool replayPaused = false;
+    sf::VertexArray treeLines(sf::Lines);
+    sf::VertexArray blockedLine(sf::Lines, 2);
+
+    sf::Text replayText;
+    replayText.setFont(font);
+    replayText.setCharacterSize(14);
+    replayText.setFillColor(sf::Color::White);
+    replayText.setPosition(20, 100);
+
+    auto showPlan = [&](const RouteResult &result)
     {
+        const RoutePlan &plan = result.plan;
+        bool rerouted = plan.rerouted;
+        if (plan.finalPath != path)
+        animationProgress = 0;
+        path = plan.finalPath;
+
+        printLine('=');
+        reportRoute(graph, plan);
+        cout << "Visualizing path: ";
+        for (int idx : path)
+        {
+            cout << graph.airportName(idx) << " ";
+        }
+        cout << "\n";
+
+        // Airports on the route keep their labels over any others.
+        for (size_t i = 0; i < graph.airports.size(); ++i)
+        labels.setPriority(i, graph.adj[i].size());
+        for (int idx : path)
+        labels.setPriority(idx, graph.airports.size() + graph.adj[idx].size());
+
+        pathAirportShapes.clear();
         for (size_t i = 0; i < path.size(); ++i)
         {
             const auto &airport = graph.airports[path[i]];
@@ -329,96 +300,42 @@ void visualizeGraph(const FlightGraph &graph, const vector<int> &path, bool rero
             shape.setPosition(airport.position.x - 2, airport.position.y - 2);
             pathAirportShapes.push_back(shape);
         }
-    }
 
-    vector<sf::VertexArray> connectionLines;
-    vector<sf::VertexArray> badWeatherLines;
-
-    vector<pair<int, int>> badWeatherPaths;
-
-    for (int i = 0; i < graph.airports.size(); ++i)
-    {
-        for (int j = i + 1; j < graph.airports.size(); ++j)
+        if (rerouted)
         {
-            sf::Color color;
-            bool isBadWeather = graph.pathWeather[i][j].isBad;
-
-            if (isBadWeather)
-            {
-                sf::VertexArray badWeatherLine(sf::Lines, 2);
-                badWeatherLine[0] = sf::Vertex(graph.airports[i].position, badWeatherColor);
-                badWeatherLine[1] = sf::Vertex(graph.airports[j].position, badWeatherColor);
-                badWeatherLines.push_back(badWeatherLine);
-
-                badWeatherPaths.push_back({i, j});
-                badWeatherPaths.push_back({j, i});
-
-                color = unavailableColor;
-            }
-            else if(!graph.pathAvailable[i][j])
-            {
-                color = sf::Color(150, 150, 150);
-            }
-            else
-            {
-                color = availableColor;
-            }
-
-            sf::VertexArray line(sf::Lines, 2);
-            line[0] = sf::Vertex(graph.airports[i].position, color);
-            line[1] = sf::Vertex(graph.airports[j].position, color);
-            connectionLines.push_back(line);
+            statusText.setString("FLIGHT REROUTED DUE TO WEATHER CONDITIONS");
+            statusText.setFillColor(sf::Color::Red);
+        }
+        else if (path.empty())
+        {
+            statusText.setString("NO PATH AVAILABLE");
+            statusText.setFillColor(sf::Color::Red);
+        }
+        else
+        {
+            statusText.setString("ORIGINAL FLIGHT PATH");
+            statusText.setFillColor(sf::Color::Green);
         }
-    }
-
-    sf::Text statusText;
-    statusText.setFont(font);
-    if (rerouted)
-    {
-        statusText.setString("FLIGHT REROUTED DUE TO WEATHER CONDITIONS");
-        statusText.setFillColor(sf::Color::Red);
-    }
-    else if (path.empty())
-    {
-        statusText.setString("NO PATH AVAILABLE");
-        statusText.setFillColor(sf::Color::Red);
-    }
-    else
-    {
-        statusText.setString("ORIGINAL FLIGHT PATH");
-        statusText.setFillColor(sf::Color::Green);
-    }
-    statusText.setCharacterSize(18);
-    statusText.setPosition(20, 20);
-
-    sf::Text pathText;
-    pathText.setFont(font);
-    string pathStr = "Path: ";
-    for (size_t i = 0; i < path.size(); ++i)
-    {
-        pathStr += graph.airports[path[i]].code;
-        if (i < path.size() - 1)
-        pathStr += " → ";
-    }
-
-    pathText.setString(pathStr);
-    pathText.setCharacterSize(16);
-    pathText.setFillColor(sf::Color::White);
-    pathText.setPosition(20, 50);
 
-    vector<sf::VertexArray> pathSegments;
-    vector<float> pathLengths;
-    vector<pair<int, int>> pathPairs;
-    float totalPathLength = 0.0f;
+        string pathStr = "Path: ";
+        for (size_t i = 0; i < path.size(); ++i)
+        {
+            pathStr += graph.airportCode(path[i]);
+            if (i < path.size() - 1)
+            pathStr += " → ";
+        }
+        pathText.setString(pathStr);
 
-    if (!path.empty())
-    {
+        pathSegments.clear();
+        pathLengths.clear();
+        pathStarts.clear();
+        totalPathLength = 0.0f;
         for (size_t i = 1; i < path.size(); ++i)
         {
             int fromIdx = path[i - 1];
             int toIdx = path[i];
-            sf::Vector2f start = graph.airports[fromIdx].position;
-            sf::Vector2f end = graph.airports[toIdx].position;
+            sf::Vector2f start = toScreen(graph.airports[fromIdx].position);
+            sf::Vector2f end = toScreen(graph.airports[toIdx].position);
 
             bool hasBadWeather = graph.pathWeather[fromIdx][toIdx].isBad;
 
@@ -426,18 +343,17 @@ void visualizeGraph(const FlightGraph &graph, const vector<int> &path, bool rero
             float dy = end.y - start.y;
             float length = sqrt(dx * dx + dy * dy);
             pathLengths.push_back(length);
+            pathStarts.push_back(totalPathLength);
             totalPathLength += length;
 
-            pathPairs.push_back({fromIdx, toIdx});
-
             sf::VertexArray segment(sf::Lines, 2);
             sf::Color actualPathColor;
 
             if (hasBadWeather)
             {
                 cout << "WARNING: Path includes bad weather segment: "
-                     << graph.airports[fromIdx].code << " -> "
-                     << graph.airports[toIdx].code << "\n";
+                     << graph.airportName(fromIdx) << " -> "
+                     << graph.airportName(toIdx) << "\n";
                 actualPathColor = sf::Color::Red;
             }
             else if (rerouted)
@@ -452,120 +368,524 @@ void visualizeGraph(const FlightGraph &graph, const vector<int> &path, bool rero
             segment[0] = sf::Vertex(start, actualPathColor);
             segment[1] = sf::Vertex(end, actualPathColor);
             pathSegments.push_back(segment);
+        }
 
-            cout << "Created path segment: " << graph.airports[fromIdx].code << " -> "<< graph.airports[toIdx].code << " (length: " << length << ")";
-
-            if (hasBadWeather)
-            {
-                cout << " [BAD WEATHER!]";
-            }
-            cout << "\n";
+        // The previous replay read the trace in the buffer just handed back.
+        replay.reset();
+        replayBudget = 0;
+        treeLines.clear();
+        blockedLine[0].color = blockedLine[1].color = sf::Color::Transparent;
+        for (size_t v = 0; v < graph.airports.size(); ++v)
+        network.setMarkerColor(v, airportColor);
+        if (result.newRoute && result.trace.lastSearch() >= 0)
+        {
+            replay = make_unique<SearchReplay>(result.trace, graph.airports.size());
+            eventsPerSecond = max(4.0, replay->length() / 3.0);
         }
-    }
+    };
+
+    sf::Text animText;
+    animText.setFont(font);
+    animText.setString("Press ESC to exit, Space to pause, B for critical segments, right-click a route to toggle weather");
+    animText.setCharacterSize(14);
+    animText.setFillColor(sf::Color::White);
+    animText.setPosition(20, 80);
+
+    // Everything but the moving aircraft and its partial route is drawn into
+    // this layer, which is redrawn only when something on it changes: a
+    // search playback step, a key press or the route appearing.
+    sf::RenderTexture staticLayer;
+    bool layerAvailable = staticLayer.create(900, 650);
+    sf::Sprite staticSprite(staticLayer.getTexture());
+    bool layerDirty = true;
+    bool idle = false;
+    MapCamera camera(window);
+    bool wasPending = false;
+
+    auto toggleWeather = [&](sf::Vector2i mouse)
+    {
+        sf::Vector2f point = window.mapPixelToCoords(mouse, camera.view);
+        auto [u, v] = network.edgeAt(point, 6 / camera.pixelsPerUnit(window));
+        if (u < 0)
+        return;
+        bool isBad = !graph.isBad(u, v);
+        StrId description = isBad ? mapStorm : graph.clearWeather;
+        // A full queue drops the click rather than waiting for the worker.
+        if (!worker.setWeather(u, v, isBad, description))
+        return;
+        graph.updateWeather(u, v, isBad, description);
+        network.updateWeather(graph);
+        if (showHeat)
+        heatStale = true;
+        cout << "Weather updated: " << graph.airportName(u) << " to " << graph.airportName(v) << " - "
+             << (isBad ? "Bad weather (" + string(graph.strings->view(mapStorm)) + ")" : "Clear skies") << endl;
+    };
+
+    auto drawStatic = [&](sf::RenderTarget &target, bool showRoute)
+    {
+        target.setView(camera.view);
+        network.drawEdges(target);
 
-    sf::Clock clock;
-    float animationProgress = 0.0f;
-    const float animationSpeed = 0.3f;
+        if (replay)
+        {
+            target.draw(treeLines);
+            target.draw(blockedLine);
+        }
 
-    sf::CircleShape airplane(6, 3);
-    airplane.setFillColor(planeColor);
-    airplane.setOrigin(6, 6);
+        network.drawMarkers(target);
 
-    while (window.isOpen())
+        if (showRoute)
+        for (const auto &shape : pathAirportShapes)
+        target.draw(shape);
+
+        labels.draw(target);
+
+        target.setView(target.getDefaultView());
+        target.draw(statusText);
+        target.draw(pathText);
+        if (replay)
+        target.draw(replayText);
+        target.draw(animText);
+        target.draw(workerText);
+        if (showHeat)
+        target.draw(heatText);
+    };
+
+    auto handleEvent = [&](const sf::Event &event)
     {
-        sf::Event event;
-        while (window.pollEvent(event))
+        if (camera.handle(event, window))
+        layerDirty = true;
         if (event.type == sf::Event::Closed)
         window.close();
+        if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Right)
+        {
+            toggleWeather({event.mouseButton.x, event.mouseButton.y});
+            layerDirty = true;
+        }
+        if (event.type != sf::Event::KeyPressed)
+        return;
+        layerDirty = true;
+        bool replaying = replay && !replay->done();
+        if (event.key.code == sf::Keyboard::Escape)
+        window.close();
+        else if (event.key.code == sf::Keyboard::Space)
+        {
+            if (replaying)
+            replayPaused = !replayPaused;
+            else
+            flightPaused = !flightPaused;
+        }
+        else if (event.key.code == sf::Keyboard::B)
+        {
+            showHeat = !showHeat;
+            heatStale = showHeat;
+            if (!showHeat)
+            network.setHeat({});
+        }
+        else if (!replay)
+        return;
+        else if (event.key.code == sf::Keyboard::Up)
+        eventsPerSecond *= 2;
+        else if (event.key.code == sf::Keyboard::Down)
+        eventsPerSecond = max(1.0, eventsPerSecond / 2);
+        else if (event.key.code == sf::Keyboard::Right && replayPaused)
+        replay->advance(1);
+        else if (event.key.code == sf::Keyboard::Left && replayPaused && replay->position() > 0)
+        replay->seek(replay->position() - 1);
+        else if (event.key.code == sf::Keyboard::R)
+        {
+            replay->restart();
+            replayBudget = 0;
+            animationProgress = 0;
+        }
+    };
 
-        float deltaTime = clock.restart().asSeconds();
-        if (!path.empty() && path.size() > 1)
+    while (window.isOpen())
+    {
+        TRACE_SCOPE_CAT("frame", "frame");
         {
-            animationProgress += deltaTime * animationSpeed;
-            if (animationProgress > 1.0f)
+            TRACE_SCOPE_CAT("update", "frame");
+            sf::Event event;
+            // Nothing moves: sleep until the user does something.
+            if (idle)
             {
-                animationProgress = 0.0f;
+                if (window.waitEvent(event))
+                handleEvent(event);
+                clock.restart();
             }
-        }
+            while (window.pollEvent(event))
+            handleEvent(event);
+            if (!window.isOpen())
+            break;
 
-        window.clear();
+            if (const RouteResult *result = worker.takeResult())
+            {
+                if (result->src >= 0)
+                showPlan(*result);
+                if (!worker.pending())
+                {
+                    ostringstream planned;
+                    planned << "Route planned in " << fixed << setprecision(2) << result->searchMs << " ms";
+                    workerText.setString(planned.str());
+                }
+                layerDirty = true;
+            }
+            if (showHeat && heatStale && !heatJob.valid())
+            {
+                startHeatJob();
+                layerDirty = true;
+            }
+            if (heatJob.valid() && heatJob.wait_for(chrono::seconds(0)) == future_status::ready)
+            {
+                vector<EdgeBetweenness> ranked = heatJob.get();
+                if (showHeat)
+                {
+                    network.setHeat(ranked);
+                    string top = "Critical segments:";
+                    printLine('=');
+                    cout << "Most critical segments (shortest routes using them):" << endl;
+                    for (size_t i = 0; i < ranked.size() && i < 10; ++i)
+                    {
+                        string segment =
+                            string(graph.airportCode(ranked[i].u)) + "-" + string(graph.airportCode(ranked[i].v));
+                        cout << "  " << i + 1 << ". " << graph.airportName(ranked[i].u) << " - "
+                             << graph.airportName(ranked[i].v) << ": " << ranked[i].score << endl;
+                        if (i < 3)
+                        top += " " + segment;
+                    }
+                    heatText.setString(top);
+                }
+                layerDirty = true;
+            }
+            if (worker.pending() != wasPending)
+            {
+                wasPending = worker.pending();
+                if (wasPending)
+                workerText.setString("Rerouting...");
+                layerDirty = true;
+            }
 
-        for (const auto &line : connectionLines)
-        window.draw(line);
+            float deltaTime = clock.restart().asSeconds();
+            bool replaying = replay && !replay->done();
+            if (replaying && !replayPaused)
+            {
+                replayBudget += deltaTime * eventsPerSecond;
+                size_t steps = static_cast<size_t>(replayBudget);
+                replayBudget -= steps;
+                if (replay->advance(steps) > 0)
+                layerDirty = true;
+            }
 
-        for (const auto &line : badWeatherLines)
-        window.draw(line);
+            if (replay && layerDirty)
+            {
+                treeLines.clear();
+                for (size_t v = 0; v < graph.airports.size(); ++v)
+                {
+                    SearchReplay::NodeState state = replay->state(v);
+                    network.setMarkerColor(v, state == SearchReplay::Settled    ? settledColor
+                                              : state == SearchReplay::Frontier ? frontierColor
+                                                                                : airportColor);
+                    int parent = replay->parent(v);
+                    if (parent < 0)
+                    continue;
+                    sf::Color color = state == SearchReplay::Settled ? settledColor : frontierColor;
+                    treeLines.append(sf::Vertex(toScreen(graph.airports[parent].position), color));
+                    treeLines.append(sf::Vertex(toScreen(graph.airports[v].position), color));
+                }
 
-        for (const auto &shape : airportShapes)
-        window.draw(shape);
+                const SearchEvent *last = replay->lastEvent();
+                bool showBlocked = !replay->done() && last && last->kind() == SearchEvent::Blocked;
+                blockedLine[0] = sf::Vertex(toScreen(graph.airports[showBlocked ? last->other() : 0].position),
+                                            showBlocked ? unavailableColor : sf::Color::Transparent);
+                blockedLine[1] = sf::Vertex(toScreen(graph.airports[showBlocked ? last->node : 0].position),
+                                            showBlocked ? unavailableColor : sf::Color::Transparent);
+
+                replayText.setString("Search: " + to_string(replay->position()) + "/" + to_string(replay->length()) +
+                                     " steps, " + to_string(replay->settledCount()) + " settled, " +
+                                     to_string(static_cast<int>(eventsPerSecond)) + " steps/s" +
+                                     (replayPaused ? " (paused)" : "") + "  [Space, Up/Down, Left/Right, R]");
+            }
 
-        for (const auto &shape : pathAirportShapes)
-        window.draw(shape);
+            if (!replaying && !flightPaused && !path.empty() && path.size() > 1)
+            {
+                animationProgress += deltaTime * animationSpeed;
+                if (animationProgress > 1.0f)
+                {
+                    animationProgress = 0.0f;
+                }
+            }
+        }
 
-        for (const auto &label : airportLabels)
-        window.draw(label);
-        if (!path.empty() && path.size() > 1)
+        // The route appears once the search playback has found it.
+        bool showRoute = !replay || replay->done();
+        bool flying = showRoute && !path.empty() && path.size() > 1;
         {
-            float distanceCovered = animationProgress * totalPathLength;
-            float accumulatedLength = 0.0f;
-            int currentSegment = -1;
-            float segmentProgress = 0.0f;
+            TRACE_SCOPE_CAT("draw", "frame");
+            if (layerDirty)
+            {
+                network.setView(camera.view, camera.pixelsPerUnit(window));
+                labels.setView(camera.view, camera.pixelsPerUnit(window));
+            }
+            if (layerAvailable && layerDirty)
+            {
+                staticLayer.clear();
+                drawStatic(staticLayer, showRoute);
+                staticLayer.display();
+            }
+            layerDirty = false;
+
+            window.clear();
+            window.setView(window.getDefaultView());
+            if (layerAvailable)
+            window.draw(staticSprite);
+            else
+            drawStatic(window, showRoute);
 
-            for (size_t i = 0; i < pathLengths.size(); ++i)
+            window.setView(camera.view);
+            if (flying)
             {
-                if (distanceCovered <= accumulatedLength + pathLengths[i])
+                float distanceCovered = animationProgress * totalPathLength;
+                int currentSegment =
+                    max<int>(0, upper_bound(pathStarts.begin(), pathStarts.end(), distanceCovered) - pathStarts.begin() - 1);
+                float segmentProgress =
+                    pathLengths[currentSegment] > 0
+                        ? min(1.0f, (distanceCovered - pathStarts[currentSegment]) / pathLengths[currentSegment])
+                        : 1.0f;
+
+                for (int i = 0; i < currentSegment; ++i)
+                {
+                    window.draw(pathSegments[i]);
+                }
+
+                if (currentSegment < pathSegments.size())
                 {
-                    currentSegment = i;
-                    segmentProgress = (distanceCovered - accumulatedLength) / pathLengths[i];
-                    break;
+                    sf::VertexArray partialSegment = pathSegments[currentSegment];
+                    sf::Vector2f start = partialSegment[0].position;
+                    sf::Vector2f end = partialSegment[1].position;
+                    sf::Vector2f partialEnd = start + (end - start) * segmentProgress;
+
+                    partialSegment[1].position = partialEnd;
+                    window.draw(partialSegment);
+
+                    airplane.setPosition(partialEnd);
+                    float angle = atan2(end.y - start.y, end.x - start.x) * 180 / 3.14159f;
+                    airplane.setRotation(angle + 90);
                 }
-                accumulatedLength += pathLengths[i];
+                window.draw(airplane);
             }
+            window.setView(window.getDefaultView());
+        }
+
+        {
+            TRACE_SCOPE_CAT("display", "frame");
+            window.display();
+        }
 
-            if (currentSegment == -1)
+        bool replaying = replay && !replay->done() && !replayPaused;
+        // Keep polling while a plan is on its way.
+        idle = !replaying && !(flying && !flightPaused) && !worker.pending() && !heatJob.valid();
+    }
+}
+
+// Flies `flights` aircraft at once between random airports on their
+// weather-aware routes, each looping over its route. Moving them all is one
+// FleetAnimation update and drawing them one batched triangle array.
+void visualizeTraffic(const FlightGraph &graph, const sf::Font &font, int flights, unsigned seed = 1)
+{
+    int n = graph.airports.size();
+    FleetAnimation fleet;
+    if (n > 1)
+    {
+        mt19937 rng(seed);
+        uniform_real_distribution<float> speed(40, 120);
+        uniform_real_distribution<float> phase(0, 1);
+        SearchWorkspace workspace;
+        // Each airport pair is searched once, however many flights share it.
+        vector<vector<Vec2>> routes(size_t(n) * n);
+        vector<char> searched(size_t(n) * n, 0);
+        for (int i = 0; i < flights; ++i)
+        {
+            int src = rng() % n;
+            int dst = (src + 1 + rng() % (n - 1)) % n;
+            vector<Vec2> &route = routes[size_t(src) * n + dst];
+            if (!searched[size_t(src) * n + dst])
             {
-                currentSegment = pathLengths.size() - 1;
-                segmentProgress = 1.0f;
+                searched[size_t(src) * n + dst] = 1;
+                vector<int> path = graph.dijkstra(src, dst, [&](int u, int v)
+                                                  { return graph.available(u, v) && !graph.isBad(u, v); }, workspace);
+                for (int airport : path)
+                route.push_back(graph.airports[airport].position);
             }
+            fleet.addFlight(route, speed(rng), phase(rng));
+        }
+    }
+    cout << "Animating " << fleet.size() << " flights" << endl;
+
+    sf::RenderWindow window;
+    {
+        TRACE_SCOPE_CAT("createWindow", "sfml");
+        window.create(sf::VideoMode(900, 650), "Flight Traffic");
+    }
+    window.setFramerateLimit(60);
 
-            for (int i = 0; i < currentSegment; ++i)
+    NetworkBatch network(graph, sf::Color(50, 120, 250));
+    MapCamera camera(window);
+    sf::RenderTexture staticLayer;
+    bool layerAvailable = staticLayer.create(900, 650);
+    sf::Sprite staticSprite(staticLayer.getTexture());
+    bool layerDirty = true;
+    LabelLayer labels(font);
+    labelAirports(labels, graph, false);
+    auto drawStatic = [&](sf::RenderTarget &target)
+    {
+        target.setView(camera.view);
+        network.drawEdges(target);
+        network.drawMarkers(target);
+        labels.draw(target);
+        target.setView(target.getDefaultView());
+    };
+
+    sf::Text infoText;
+    infoText.setFont(font);
+    infoText.setCharacterSize(16);
+    infoText.setFillColor(sf::Color::White);
+    infoText.setPosition(20, 20);
+
+    sf::VertexArray aircraft(sf::Triangles);
+    sf::Clock clock;
+    sf::Clock fpsClock;
+    int frames = 0;
+    bool paused = false;
+
+    auto handleEvent = [&](const sf::Event &event)
+    {
+        if (camera.handle(event, window))
+        layerDirty = true;
+        if (event.type == sf::Event::Closed ||
+            (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape))
+        window.close();
+        else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Space)
+        paused = !paused;
+    };
+
+    while (window.isOpen())
+    {
+        TRACE_SCOPE_CAT("frame", "frame");
+        {
+            TRACE_SCOPE_CAT("update", "frame");
+            sf::Event event;
+            if (paused && !layerDirty && window.waitEvent(event))
             {
-                window.draw(pathSegments[i]);
+                handleEvent(event);
+                clock.restart();
             }
+            while (window.pollEvent(event))
+            handleEvent(event);
 
-            if (currentSegment < pathSegments.size())
-            {
-                sf::VertexArray partialSegment = pathSegments[currentSegment];
-                sf::Vector2f start = partialSegment[0].position;
-                sf::Vector2f end = partialSegment[1].position;
-                sf::Vector2f partialEnd = start + (end - start) * segmentProgress;
+            float deltaTime = clock.restart().asSeconds();
+            if (!paused)
+            fleet.update(deltaTime);
 
-                partialSegment[1].position = partialEnd;
-                window.draw(partialSegment);
+            buildAircraftVertices(aircraft, fleet, camera, camera.pixelsPerUnit(window));
 
-                airplane.setPosition(partialEnd);
-                float angle = atan2(end.y - start.y, end.x - start.x) * 180 / 3.14159f;
-                airplane.setRotation(angle + 90);
+            ++frames;
+            if (fpsClock.getElapsedTime().asSeconds() >= 0.5f || paused)
+            {
+                float fps = frames / max(fpsClock.restart().asSeconds(), 1e-3f);
+                frames = 0;
+                infoText.setString(to_string(fleet.size()) + " flights, " + to_string(static_cast<int>(fps)) +
+                                   " fps" + (paused ? " (paused)" : "") +
+                                   "  [Space pause, wheel zoom, drag pan, Home reset, Esc exit]");
             }
-            window.draw(airplane);
         }
 
-        window.draw(statusText);
-        window.draw(pathText);
+        {
+            TRACE_SCOPE_CAT("draw", "frame");
+            if (layerDirty)
+            {
+                network.setView(camera.view, camera.pixelsPerUnit(window));
+                labels.setView(camera.view, camera.pixelsPerUnit(window));
+                if (layerAvailable)
+                {
+                    staticLayer.clear();
+                    drawStatic(staticLayer);
+                    staticLayer.display();
+                }
+                layerDirty = false;
+            }
 
-        sf::Text animText;
-        animText.setFont(font);
-        animText.setString("Press ESC to exit");
-        animText.setCharacterSize(14);
-        animText.setFillColor(sf::Color::White);
-        animText.setPosition(20, 80);
-        window.draw(animText);
+            window.clear();
+            window.setView(window.getDefaultView());
+            if (layerAvailable)
+            window.draw(staticSprite);
+            else
+            drawStatic(window);
+            window.setView(camera.view);
+            window.draw(aircraft);
+            window.setView(window.getDefaultView());
+            window.draw(infoText);
+        }
 
-        window.display();
+        {
+            TRACE_SCOPE_CAT("display", "frame");
+            window.display();
+        }
+    }
+}
 
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Escape))
-        window.close();
+// Resident mode: keeps the graph, its weather and the font loaded and serves
+// route requests and weather deltas pushed by flight_booking through the
+// shared-memory channel, instead of being relaunched for every booking.
+int runDaemon(FlightGraph &graph, const sf::Font &font)
+{
+    SimChannel channel;
+    if (!channel.create())
+    {
+        cerr << "Could not create the simulator channel (is another simulator already running?)" << endl;
+        return 1;
+    }
+
+    int n = graph.airports.size();
+    printLine('=');
+    cout << "FLIGHT SIMULATOR DAEMON" << endl;
+    printLine('=');
+    cout << "Waiting for bookings..." << endl;
+
+    SimMessage message;
+    while (channel.pop(message))
+    {
+        if (message.type == SimMessage::Shutdown)
+        break;
+
+        if (message.u < 0 || message.u >= n || message.v < 0 || message.v >= n)
+        {
+            cerr << "Ignoring message with invalid airport indices " << message.u << ", " << message.v << endl;
+            continue;
+        }
+
+        if (message.type == SimMessage::Weather)
+        {
+            if (message.u == message.v)
+            continue;
+            // The producer is another process; don't trust it to terminate
+            // the description.
+            string_view description(message.description, strnlen(message.description, sizeof message.description));
+            graph.updateWeather(message.u, message.v, message.isBad != 0, description);
+            cout << "Weather updated: "
+                 << graph.airportName(message.u) << " to "
+                 << graph.airportName(message.v) << " - "
+                 << (message.isBad ? "Bad weather (" + string(description) + ")" : "Clear skies")
+                 << endl;
+        }
+        else if (message.type == SimMessage::Route)
+        {
+            printLine('=');
+            cout << "Selected route: " << graph.airportName(message.u) << " to " << graph.airportName(message.v) << endl;
+            visualizeGraph(graph, font, message.u, message.v);
+            cout << "Waiting for bookings..." << endl;
+        }
     }
+    return 0;
 }
 
 int main(int argc, char *argv[])
@@ -574,8 +894,14 @@ int main(int argc, char *argv[])
 
     int src = -1, dst = -1;
     bool useCommandLineArgs = false;
+    bool daemonMode = argc == 2 && string(argv[1]) == "--daemon";
+    int trafficFlights = argc == 3 && string(argv[1]) == "--traffic" ? max(1, atoi(argv[2])) : 0;
 
-    if (argc == 3)
+    // FLIGHT_TRACE=trace.json records a Chrome trace of this run.
+    const char *tracePath = getenv("FLIGHT_TRACE");
+    TraceSession traceSession(tracePath ? tracePath : "");
+
+    if (argc == 3 && !trafficFlights)
     {
         try
         {
@@ -593,34 +919,28 @@ int main(int argc, char *argv[])
 
     FlightGraph graph;
 
-    graph.addAirport("John F. Kennedy International Airport (New York)", 150, 100);
-    graph.addAirport("Los Angeles International Airport (Los Angeles)", 50, 500);
-    graph.addAirport("O'Hare International Airport (Chicago)", 350, 150);
-    graph.addAirport("Dallas/Fort Worth International Airport (Dallas–Fort Worth)", 450, 350);
-    graph.addAirport("Hartsfield–Jackson Atlanta International Airport (Atlanta)", 300, 300);
-    graph.addAirport("San Francisco International Airport (San Francisco)", 100, 450);
-    graph.addAirport("Miami International Airport (Miami)", 250, 550);
-    graph.addAirport("Seattle–Tacoma International Airport (Seattle)", 50, 50);
-    graph.addAirport("Denver International Airport (Denver)", 300, 200);
-    graph.addAirport("Logan International Airport (Boston)", 200, 80);
-    graph.addAirport("Harry Reid International Airport (Las Vegas) (formerly McCarran)", 150, 450);
-    graph.addAirport("Phoenix Sky Harbor International Airport (Phoenix)", 350, 450);
-    graph.addAirport("George Bush Intercontinental Airport (Houston)", 500, 400);
-    graph.addAirport("Newark Liberty International Airport (Newark)", 180, 90);
-    graph.addAirport("Charlotte Douglas International Airport (Charlotte)", 330, 280);
-
+    buildDefaultNetwork(graph);
     int n = graph.airports.size();
-    for (int i = 0; i < n; ++i)
+
+    sf::Font font;
+    bool fontLoaded;
     {
-        for (int j = i + 1; j < n; ++j)
-        {
-            const auto &pi = graph.airports[i].position;
-            const auto &pj = graph.airports[j].position;
-            double dx = pi.x - pj.x;
-            double dy = pi.y - pj.y;
-            double dist = sqrt(dx * dx + dy * dy);
-            graph.addEdge(i, j, dist);
-        }
+        TRACE_SCOPE_CAT("loadFont", "sfml");
+        fontLoaded = font.loadFromFile("default.ttf");
+    }
+    if (!fontLoaded)
+    {
+        cerr << "Error loading font 'default.ttf'. Make sure it's available.\n";
+        return 1;
+    }
+
+    if (daemonMode)
+    return runDaemon(graph, font);
+
+    if (trafficFlights)
+    {
+        visualizeTraffic(graph, font, trafficFlights);
+        return 0;
     }
 
     printLine('=');
@@ -632,7 +952,7 @@ int main(int argc, char *argv[])
         cout << "Available Airports (index: code):" << endl;
         for (int i = 0; i < n; ++i)
         {
-            cout << "  " << i << ": " << graph.airports[i].code << endl;
+            cout << "  " << i << ": " << graph.airportCode(i) << " - " << graph.airportName(i) << endl;
         }
         printLine();
 
@@ -645,7 +965,7 @@ int main(int argc, char *argv[])
             cout << "Enter departure index or code: ";
             cout.flush();
             cin >> input;
-            src = resolveAirportIndex(input, graph.airports);
+            src = resolveAirportIndex(input, graph);
 
             if (src < 0 || src >= n)
             {
@@ -659,7 +979,7 @@ int main(int argc, char *argv[])
             cout << "Enter arrival index or code:   ";
             cout.flush();
             cin >> input;
-            dst = resolveAirportIndex(input, graph.airports);
+            dst = resolveAirportIndex(input, graph);
 
             if (dst < 0 || dst >= n)
             {
@@ -679,7 +999,7 @@ int main(int argc, char *argv[])
         }
     }
 
-    cout << "Selected route: " << graph.airports[src].code << " to " << graph.airports[dst].code << endl;
+    cout << "Selected route: " << graph.airportName(src) << " to " << graph.airportName(dst) << endl;
 
     printLine('=');
     cout << "WEATHER CONDITIONS UPDATE" << endl;
@@ -733,165 +1053,13 @@ int main(int argc, char *argv[])
             graph.updateWeather(a1, a2, condition == 1, description);
 
             cout << "Weather updated: "
-                 << graph.airports[a1].code << " to "
-                 << graph.airports[a2].code << " - "
+                 << graph.airportName(a1) << " to "
+                 << graph.airportName(a2) << " - "
                  << (condition == 1 ? "Bad weather (" + description + ")" : "Clear skies")
                  << endl;
         }
     }
 
-    FlightGraph directGraph = graph;
-
-    for (int i = 0; i < directGraph.airports.size(); ++i)
-    {
-        for (int j = 0; j < directGraph.airports.size(); ++j)
-        {
-            if (i != j)
-            {
-                directGraph.pathAvailable[i][j] = true;
-            }
-        }
-    }
-
-    vector<int> directPath = directGraph.dijkstra(src, dst);
-
-    FlightGraph weatherGraph = graph;
-
-    for (int i = 0; i < weatherGraph.airports.size(); ++i)
-    {
-        for (int j = 0; j < weatherGraph.airports.size(); ++j)
-        {
-            if (weatherGraph.pathWeather[i][j].isBad)
-            {
-                weatherGraph.pathAvailable[i][j] = false;
-            }
-        }
-    }
-
-    vector<int> weatherAwarePath = weatherGraph.dijkstra(src, dst);
-
-    bool hasDirectPathBadWeather = false;
-    vector<pair<string, string>> badWeatherSegments;
-
-    if (!directPath.empty())
-    {
-        badWeatherSegments = graph.getPathWeatherInfo(directPath);
-        hasDirectPathBadWeather = !badWeatherSegments.empty();
-    }
-
-    bool rerouted = false;
-    vector<int> finalPath;
-
-    if (weatherAwarePath.empty())
-    {
-        cout << "No path found between the selected airports due to weather conditions.\n";
-        finalPath = weatherAwarePath;
-    }
-    else if (hasDirectPathBadWeather)
-    {
-        cout << "\nBAD WEATHER DETECTED on the direct route!\n";
-        cout << "Affected segments:\n";
-        for (const auto &segment : badWeatherSegments)
-        {
-            cout << "  " << segment.first << ": " << segment.second << "\n";
-        }
-
-        bool pathsAreDifferent = directPath.size() != weatherAwarePath.size() || !equal(directPath.begin(), directPath.end(), weatherAwarePath.begin());
-
-        if (pathsAreDifferent && !weatherAwarePath.empty())
-        {
-            cout << "Automatically rerouted to avoid bad weather.\n";
-            rerouted = true;
-            finalPath = weatherAwarePath;
-
-            bool finalPathHasBadWeather = false;
-            for (size_t i = 1; i < finalPath.size(); ++i)
-            {
-                int u = finalPath[i - 1];
-                int v = finalPath[i];
-                if (graph.pathWeather[u][v].isBad)
-                {
-                    finalPathHasBadWeather = true;
-                    cout << "WARNING: Rerouted path still contains bad weather segment: "<< graph.airports[u].code << " -> " << graph.airports[v].code << "\n";
-                }
-            }
-
-            if (finalPathHasBadWeather)
-            {
-                cout << "Fixing rerouted path to completely avoid bad weather...\n";
-                FlightGraph fixedGraph = graph;
-                for (int i = 0; i < fixedGraph.airports.size(); ++i)
-                {
-                    for (int j = 0; j < fixedGraph.airports.size(); ++j)
-                    {
-                        if (fixedGraph.pathWeather[i][j].isBad)
-                        {
-                            fixedGraph.pathAvailable[i][j] = false;
-                        }
-                    }
-                }
-                finalPath = fixedGraph.dijkstra(src, dst);
-
-                if (finalPath.empty())
-                {
-                    cout << "No completely safe path found. Using best available route.\n";
-                    finalPath = weatherAwarePath;
-                }
-            }
-
-            cout << "New route: ";
-            for (int idx : finalPath)
-            cout << graph.airports[idx].code << " ";
-            cout << "\n";
-        }
-        else
-        {
-            cout << "Attempting to find alternative route...\n";
-
-            FlightGraph rerouteGraph = graph;
-
-            for (int i = 0; i < rerouteGraph.airports.size(); ++i)
-            {
-                for (int j = 0; j < rerouteGraph.airports.size(); ++j)
-                {
-                    if (rerouteGraph.pathWeather[i][j].isBad)
-                    {
-                        rerouteGraph.pathAvailable[i][j] = false;
-                    }
-                }
-            }
-
-            vector<int> alternativePath = rerouteGraph.dijkstra(src, dst);
-
-            if (alternativePath.empty())
-            {
-                cout << "No alternative route found. All possible paths are affected by bad weather.\n";
-                finalPath = weatherAwarePath;
-            }
-            else
-            {
-                cout << "REROUTED SUCCESSFULLY!\n";
-                rerouted = true;
-                finalPath = alternativePath;
-
-                cout << "New route: ";
-                for (int idx : finalPath)
-                cout << graph.airports[idx].code << " ";
-                cout << "\n";
-            }
-        }
-    }
-    else
-    {
-        cout << "Route has good weather conditions.\n";
-        finalPath = weatherAwarePath;
-
-        cout << "Shortest path: ";
-        for (int idx : finalPath)
-        cout << graph.airports[idx].code << " ";
-        cout << "\n";
-    }
-
-    visualizeGraph(graph, finalPath, rerouted);
+    visualizeGraph(graph, font, src, dst);
     return 0;
 }
@@ -0,0 +1,229 @@
+#ifndef GRAPH_CORE_H
+#define GRAPH_CORE_H
+
+// Integer-ID shortest-path searches shared by FlightGraph and the program
+// run.cpp generates. An adjacency is anything whose size() is the node
+// count and whose [u] iterates (target, weight) pairs with targets in
+// 0..size()-1: FlightGraph::adj, or RunGraph::adj in run_algorithms.h.
+// Node names are resolved at the API boundary (NodeIndex here, StringPool
+// for FlightGraph), so the loops below never hash or copy a string.
+//
+// Written against C++11 so the program run.cpp generates can use it too.
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Interns node names as dense IDs, in the order they are first seen.
+class NodeIndex
+{
+public:
+    int intern(const std::string &name)
+    {
+        std::unordered_map<std::string, int>::const_iterator it = ids.find(name);
+        if (it != ids.end())
+        return it->second;
+        ids.emplace(name, static_cast<int>(names.size()));
+        names.push_back(name);
+        return static_cast<int>(names.size()) - 1;
+    }
+
+    // -1 if the name was never interned.
+    int find(const std::string &name) const
+    {
+        std::unordered_map<std::string, int>::const_iterator it = ids.find(name);
+        return it == ids.end() ? -1 : it->second;
+    }
+
+    // Throws std::out_of_range if the name was never interned.
+    int id(const std::string &name) const { return ids.at(name); }
+
+    const std::string &name(int id) const { return names[id]; }
+    int size() const { return static_cast<int>(names.size()); }
+
+private:
+    std::unordered_map<std::string, int> ids;
+    std::vector<std::string> names;
+};
+
+// Distances, parents and heap for one search. Keep one per thread; only
+// the entries a search touches need resetting before the next.
+struct SearchBuffers
+{
+    std::vector<double> dist;
+    std::vector<int> prev;
+    std::vector<std::pair<double, int>> heap;
+    std::vector<int> touched;
+
+    void prepare(std::size_t n)
+    {
+        if (dist.size() < n)
+        {
+            dist.resize(n, std::numeric_limits<double>::infinity());
+            prev.resize(n, -1);
+        }
+    }
+
+    void reset()
+    {
+        for (int v : touched)
+        {
+            dist[v] = std::numeric_limits<double>::infinity();
+            prev[v] = -1;
+        }
+        touched.clear();
+    }
+};
+
+// Receives bestFirstSearch()'s events. These do nothing, so a search
+// observed by NoSearchHooks compiles to the bare loop.
+struct NoSearchHooks
+{
+    // settle(node, parent): a node's final distance is known.
+    void settle(int, int) {}
+    // found(node, parent): the target came off the heap; the search stops.
+    void found(int, int) {}
+    void stalePop() {}
+    // blocked(node, from): an arc `available` refused.
+    void blocked(int, int) {}
+    // relax(node, from): a shorter distance to node was found and pushed.
+    void relax(int, int) {}
+};
+
+// Counts the nodes a search takes off the heap, including the target.
+struct SettledCounter : NoSearchHooks
+{
+    std::size_t settled = 0;
+
+    void settle(int, int) { ++settled; }
+    void found(int, int) { ++settled; }
+};
+
+struct AnyArc
+{
+    bool operator()(int, int) const { return true; }
+};
+
+// Plain Dijkstra: every remaining distance is estimated as zero.
+struct ZeroHeuristic
+{
+    double operator()(int) const { return 0; }
+};
+
+// Dijkstra, or A* when `heuristic(v)` estimates the remaining distance from
+// v, over the arcs `available(u, v)` allows. Stops when dst comes off the
+// heap; dst < 0 settles every reachable node. Distances and parents are
+// left in `buffers` (see searchPath()); the caller resets it before the next
+// search. The heuristic must never overestimate for the result to be a
+// shortest path.
+template <typename Adjacency, typename Available, typename Heuristic, typename Hooks>
+void bestFirstSearch(const Adjacency &adj, int src, int dst, const Available &available, const Heuristic &heuristic,
+                     SearchBuffers &buffers, Hooks &hooks)
+{
+    typedef std::pair<double, int> PDI;
+    buffers.prepare(adj.size());
+    std::vector<double> &dist = buffers.dist;
+    std::vector<int> &prev = buffers.prev;
+    std::vector<PDI> &heap = buffers.heap;
+    dist[src] = 0;
+    buffers.touched.push_back(src);
+    heap.assign(1, PDI(heuristic(src), src));
+
+    while (!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<PDI>());
+        PDI top = heap.back();
+        heap.pop_back();
+        int u = top.second;
+        if (u == dst)
+        {
+            hooks.found(u, prev[u]);
+            break;
+        }
+        // Recomputes the expression the entry was pushed with, so an entry
+        // is current exactly when the two are equal.
+        if (top.first > dist[u] + heuristic(u))
+        {
+            hooks.stalePop();
+            continue;
+        }
+        hooks.settle(u, prev[u]);
+
+        for (const auto &arc : adj[u])
+        {
+            int v = arc.first;
+            if (!available(u, v))
+            {
+                hooks.blocked(v, u);
+                continue;
+            }
+            double alt = dist[u] + arc.second;
+            if (alt < dist[v])
+            {
+                if (prev[v] == -1 && v != src)
+                buffers.touched.push_back(v);
+                dist[v] = alt;
+                prev[v] = u;
+                heap.push_back(PDI(alt + heuristic(v), v));
+                std::push_heap(heap.begin(), heap.end(), std::greater<PDI>());
+                hooks.relax(v, u);
+            }
+        }
+    }
+}
+
+// Relaxes every arc in rounds until one changes nothing, at most n - 1 of
+// them. Slower than bestFirstSearch() but allows negative weights (not
+// negative cycles). Leaves distances and parents in `buffers`.
+template <typename Adjacency>
+void bellmanFordSearch(const Adjacency &adj, int src, SearchBuffers &buffers)
+{
+    int n = static_cast<int>(adj.size());
+    buffers.prepare(n);
+    std::vector<double> &dist = buffers.dist;
+    std::vector<int> &prev = buffers.prev;
+    dist[src] = 0;
+    buffers.touched.push_back(src);
+    bool changed = true;
+    for (int round = 1; round < n && changed; ++round)
+    {
+        changed = false;
+        for (int u = 0; u < n; ++u)
+        {
+            if (dist[u] == std::numeric_limits<double>::infinity())
+            continue;
+            for (const auto &arc : adj[u])
+            {
+                int v = arc.first;
+                if (dist[u] + arc.second < dist[v])
+                {
+                    if (prev[v] == -1 && v != src)
+                    buffers.touched.push_back(v);
+                    dist[v] = dist[u] + arc.second;
+                    prev[v] = u;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+// The src -> dst path a search left in `buffers`; empty if dst was not
+// reached.
+inline std::vector<int> searchPath(const SearchBuffers &buffers, int src, int dst)
+{
+    std::vector<int> path;
+    if (dst != src && buffers.prev[dst] == -1)
+    return path;
+    for (int at = dst; at != -1; at = buffers.prev[at])
+    path.push_back(at);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+#endif
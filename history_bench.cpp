@@ -0,0 +1,140 @@
+// history_bench.cpp
+// Times WeatherHistory on a synthetic day: storms open and clear on random
+// segments of the default network (or a random one of --airports airports),
+// then the day is reconstructed at random times and replayed through the
+// router with timestamped route queries (replayRoutes). Prints the log size,
+// the time to restore one timestamp and how much faster than real time the
+// replay runs.
+//
+// Usage: history_bench [--airports N] [--events N] [--queries N] [--seed N]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "cli_args.h"
+#include "flight_graph.h"
+#include "weather_history.h"
+using namespace std;
+
+struct HistoryBenchOptions
+{
+    // 0 for the default network.
+    int airports = 0;
+    int events = 18000;
+    int queries = 90000;
+    unsigned seed = 1;
+};
+
+void printUsage()
+{
+    cerr << "Usage: history_bench [--airports N] [--events N] [--queries N] [--seed N]" << endl;
+}
+
+bool parseOptions(int argc, char *argv[], HistoryBenchOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--airports" && i + 1 < argc)
+        options.airports = parseArg<int>(arg, argv[++i]);
+        else if (arg == "--events" && i + 1 < argc)
+        options.events = parseArg<int>(arg, argv[++i]);
+        else if (arg == "--queries" && i + 1 < argc)
+        options.queries = parseArg<int>(arg, argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc)
+        options.seed = parseArg<unsigned>(arg, argv[++i]);
+        else
+        {
+            cerr << "Unknown argument: " << arg << endl;
+            printUsage();
+            return false;
+        }
+    }
+    return (options.airports == 0 || options.airports >= 2) && options.events >= 0 && options.queries >= 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const int64_t day = 24 * 3600 * 1000LL;
+
+    HistoryBenchOptions options;
+    try
+    {
+        if (!parseOptions(argc, argv, options))
+        return 1;
+    }
+    catch (const invalid_argument &e)
+    {
+        cerr << e.what() << endl;
+        printUsage();
+        return 1;
+    }
+
+    FlightGraph graph;
+    if (options.airports)
+    buildRandomNetwork(graph, options.airports, 6, options.seed);
+    else
+    buildDefaultNetwork(graph);
+    int n = graph.airports.size();
+    vector<pair<int, int>> edges;
+    for (int u = 0; u < static_cast<int>(graph.adj.size()); ++u)
+    for (auto [v, w] : graph.adj[u])
+    if (u < v)
+    edges.push_back({u, v});
+
+    // Event times spread evenly over the day with random jitter; each event
+    // flips one random segment between a storm and clear skies.
+    mt19937 rng(options.seed);
+    vector<char> stormy(edges.size(), 0);
+    WeatherHistory history(graph, 0);
+    auto start = chrono::steady_clock::now();
+    int64_t time = 0;
+    for (int i = 0; i < options.events; ++i)
+    {
+        time += rng() % (2 * day / max(options.events, 1) + 1);
+        size_t e = rng() % edges.size();
+        stormy[e] = !stormy[e];
+        history.record(time, edges[e].first, edges[e].second, stormy[e], stormy[e] ? "Thunderstorm" : "Clear skies");
+    }
+    double recordMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    const int restores = 1000;
+    FlightGraph past = graph;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < restores; ++i)
+    history.restore(past, int64_t(rng() % uint64_t(history.endTime() + 1)));
+    double restoreUs = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / restores;
+
+    vector<TimedRouteQuery> queries;
+    for (int i = 0; i < options.queries; ++i)
+    {
+        int src = rng() % n;
+        int dst = (src + 1 + rng() % (n - 1)) % n;
+        queries.push_back({int64_t(rng() % uint64_t(history.endTime() + 1)), src, dst});
+    }
+    sort(queries.begin(), queries.end(),
+         [](const TimedRouteQuery &a, const TimedRouteQuery &b) { return a.timestamp < b.timestamp; });
+    size_t routed = 0, rerouted = 0;
+    start = chrono::steady_clock::now();
+    replayRoutes(history, graph, 0, history.endTime(), queries, [&](const TimedRouteQuery &, const RoutePlan &plan)
+    {
+        ++routed;
+        rerouted += plan.rerouted;
+    });
+    double replaySeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Network: " << n << " airports, " << edges.size() << " segments" << endl;
+    cout << "Recorded " << history.eventCount() << " events over " << history.endTime() / 3600000.0 << " h in "
+         << recordMs << " ms: " << history.logBytes() << " bytes ("
+         << double(history.logBytes()) / max<size_t>(history.eventCount(), 1) << " per event), "
+         << history.checkpointCount() << " checkpoints" << endl;
+    cout << "Restore at a random time: " << restoreUs << " us" << endl;
+    cout << "Replayed " << routed << " route queries (" << rerouted << " rerouted) in " << replaySeconds * 1000
+         << " ms, " << history.endTime() / 1000.0 / max(replaySeconds, 1e-9) << "x real time" << endl;
+    return 0;
+}
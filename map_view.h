@@ -0,0 +1,654 @@
+#ifndef MAP_VIEW_H
+#define MAP_VIEW_H
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "betweenness.h"
+#include "fleet_animation.h"
+#include "flight_graph.h"
+#include "quadtree.h"
+
+// Map drawing shared by the simulator window and the offscreen render
+// benchmark. Needs SFML, so it stays out of the routing library.
+
+inline sf::Vector2f toScreen(Vec2 position)
+{
+    return {position.x, position.y};
+}
+
+// Zoom and pan of the map: the mouse wheel zooms about the cursor, dragging
+// with the left button pans and Home restores the starting view.
+struct MapCamera
+{
+    static constexpr float kMaxZoom = 64;
+
+    sf::View view;
+    sf::View home;
+    bool dragging = false;
+    sf::Vector2i lastMouse;
+
+    explicit MapCamera(const sf::RenderTarget &target) : view(target.getDefaultView()), home(view) {}
+
+    // Returns true if the event moved the view.
+    bool handle(const sf::Event &event, const sf::RenderTarget &target)
+    {
+        if (event.type == sf::Event::MouseWheelScrolled && event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel)
+        {
+            sf::Vector2i mouse(event.mouseWheelScroll.x, event.mouseWheelScroll.y);
+            float factor = event.mouseWheelScroll.delta > 0 ? 1 / 1.25f : 1.25f;
+            float zoom = home.getSize().x / (view.getSize().x * factor);
+            if (zoom > kMaxZoom || zoom < 1 / kMaxZoom)
+            return false;
+            // Keep the map point under the cursor where it is.
+            sf::Vector2f before = target.mapPixelToCoords(mouse, view);
+            view.zoom(factor);
+            view.move(before - target.mapPixelToCoords(mouse, view));
+            return true;
+        }
+        if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left)
+        {
+            dragging = true;
+            lastMouse = {event.mouseButton.x, event.mouseButton.y};
+        }
+        else if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left)
+        {
+            dragging = false;
+        }
+        else if (event.type == sf::Event::MouseMoved && dragging)
+        {
+            sf::Vector2i mouse(event.mouseMove.x, event.mouseMove.y);
+            view.move(target.mapPixelToCoords(lastMouse, view) - target.mapPixelToCoords(mouse, view));
+            lastMouse = mouse;
+            return true;
+        }
+        else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Home)
+        {
+            view = home;
+            return true;
+        }
+        return false;
+    }
+
+    // Screen pixels per map unit.
+    float pixelsPerUnit(const sf::RenderTarget &target) const { return target.getSize().x / view.getSize().x; }
+
+    bool contains(sf::Vector2f point) const
+    {
+        sf::Vector2f centre = view.getCenter(), size = view.getSize();
+        return std::abs(point.x - centre.x) <= size.x / 2 && std::abs(point.y - centre.y) <= size.y / 2;
+    }
+};
+
+// The route network drawn from three vertex buffers held on the GPU: the
+// edges, the bad-weather overlay and the airport markers, so a frame costs
+// three draw calls. Only what lies in the current view is uploaded: quadtrees
+// over airport positions and edge bounding boxes find the visible primitives,
+// and level-of-detail rules keep the count bounded however large the network
+// is. Airports in a region smaller than kClusterPixels on screen merge into
+// one marker, good-weather edges shorter than kMinEdgePixels are dropped,
+// and beyond kEdgeBudget visible edges the rest of those are thinned out.
+// Everything is rebuilt only when the view, the weather or a marker colour
+// changes. Without vertex buffer support the same vertices are drawn from
+// client memory.
+class NetworkBatch
+{
+public:
+    static constexpr float kMarkerRadius = 8;
+    static constexpr int kMarkerSegments = 12;
+    static constexpr float kClusterPixels = 12;
+    static constexpr float kMinEdgePixels = 4;
+    static constexpr std::size_t kEdgeBudget = 50000;
+
+    NetworkBatch(const FlightGraph &graph, sf::Color markerColor)
+        : gpu(sf::VertexBuffer::isAvailable()), airportTree(mapBounds(graph)), edgeTree(mapBounds(graph)),
+          edgeBuffer(sf::Lines, sf::VertexBuffer::Stream), weatherBuffer(sf::Lines, sf::VertexBuffer::Stream),
+          markerBuffer(sf::Triangles, sf::VertexBuffer::Stream), defaultMarkerColor(markerColor)
+    {
+        for (std::size_t i = 0; i < graph.airports.size(); ++i)
+        {
+            positions.push_back(toScreen(graph.airports[i].position));
+            airportTree.insert(i, boxAround(positions[i].x, positions[i].y, positions[i].x, positions[i].y));
+        }
+        for (int u = 0; u < static_cast<int>(graph.adj.size()); ++u)
+        for (auto [v, w] : graph.adj[u])
+        if (u < v)
+        {
+            edgeTree.insert(edges.size(), boxAround(positions[u].x, positions[u].y, positions[v].x, positions[v].y));
+            edges.push_back({u, v});
+        }
+        markerColors.assign(graph.airports.size(), markerColor);
+        updateWeather(graph);
+    }
+
+    // Recolours the edges from the graph's weather.
+    void updateWeather(const FlightGraph &graph)
+    {
+        edgeBad.resize(edges.size());
+        edgeOpen.resize(edges.size());
+        for (std::size_t e = 0; e < edges.size(); ++e)
+        {
+            auto [u, v] = edges[e];
+            edgeBad[e] = graph.isBad(u, v);
+            edgeOpen[e] = !edgeBad[e] && graph.available(u, v);
+        }
+        recolor();
+    }
+
+    // Heatmap: colours each open edge by its score, from dim blue through
+    // yellow to red for the most critical. An empty list turns it off.
+    void setHeat(const std::vector<EdgeBetweenness> &scores)
+    {
+        edgeHeat.clear();
+        if (!scores.empty())
+        {
+            if (edgeIndex.empty())
+            for (std::size_t e = 0; e < edges.size(); ++e)
+            edgeIndex.emplace(edgeKey(edges[e].first, edges[e].second), e);
+            double top = 0;
+            for (const EdgeBetweenness &edge : scores)
+            top = std::max(top, edge.score);
+            edgeHeat.assign(edges.size(), 0);
+            for (const EdgeBetweenness &edge : scores)
+            {
+                auto it = edgeIndex.find(edgeKey(edge.u, edge.v));
+                // Square root spreads out the many low scores.
+                if (it != edgeIndex.end() && top > 0)
+                edgeHeat[it->second] = static_cast<float>(std::sqrt(edge.score / top));
+            }
+        }
+        recolor();
+    }
+
+    void setMarkerColor(int airport, sf::Color color)
+    {
+        if (markerColors[airport] == color)
+        return;
+        markerColors[airport] = color;
+        markersDirty = true;
+    }
+
+    // Culls to the part of the map in `view` shown `pixelsPerUnit` screen
+    // pixels per map unit. Does nothing if neither has changed.
+    void setView(const sf::View &view, float pixelsPerUnit)
+    {
+        sf::Vector2f centre = view.getCenter(), size = view.getSize();
+        Box visible = {centre.x - size.x / 2 - kMarkerRadius * 2, centre.y - size.y / 2 - kMarkerRadius * 2,
+                       centre.x + size.x / 2, centre.y + size.y / 2};
+        if (!viewDirty && pixelsPerUnit == scale && visible.minX == area.minX && visible.minY == area.minY &&
+            visible.maxX == area.maxX && visible.maxY == area.maxY)
+        return;
+        area = visible;
+        scale = pixelsPerUnit;
+        viewDirty = false;
+        cullEdges();
+        cullAirports();
+    }
+
+    // The edge passing closest to `point`, if it is within `radius` map
+    // units, as its two airports; {-1, -1} if none is.
+    std::pair<int, int> edgeAt(sf::Vector2f point, float radius) const
+    {
+        std::pair<int, int> nearest = {-1, -1};
+        float best = radius * radius;
+        edgeTree.query(boxAround(point.x - radius, point.y - radius, point.x + radius, point.y + radius),
+                       [&](int e)
+                       {
+                           sf::Vector2f a = positions[edges[e].first], b = positions[edges[e].second];
+                           sf::Vector2f ab = b - a, ap = point - a;
+                           float length = ab.x * ab.x + ab.y * ab.y;
+                           float t = length > 0 ? std::clamp((ap.x * ab.x + ap.y * ab.y) / length, 0.0f, 1.0f) : 0;
+                           sf::Vector2f offset = ap - t * ab;
+                           float distance = offset.x * offset.x + offset.y * offset.y;
+                           if (distance <= best)
+                           {
+                               best = distance;
+                               nearest = edges[e];
+                           }
+                       });
+        return nearest;
+    }
+
+    // Map point just right of an airport's marker, where its label starts.
+    static sf::Vector2f labelAnchor(Vec2 position)
+    {
+        return toScreen(position) + sf::Vector2f(2 * kMarkerRadius, kMarkerRadius);
+    }
+
+    float pixelsPerUnit() const { return scale; }
+
+    void drawEdges(sf::RenderTarget &target)
+    {
+        draw(target, edgeBuffer, edgeVertices, sf::Lines);
+        draw(target, weatherBuffer, weatherVertices, sf::Lines);
+    }
+
+    void drawMarkers(sf::RenderTarget &target)
+    {
+        if (markersDirty)
+        buildMarkers();
+        draw(target, markerBuffer, markerVertices, sf::Triangles);
+    }
+
+private:
+    struct Cluster
+    {
+        sf::Vector2f centre;
+        int count;
+    };
+
+    static Box mapBounds(const FlightGraph &graph)
+    {
+        Box bounds = {0, 0, 1, 1};
+        for (const auto &airport : graph.airports)
+        {
+            sf::Vector2f p = toScreen(airport.position);
+            bounds = {std::min(bounds.minX, p.x), std::min(bounds.minY, p.y), std::max(bounds.maxX, p.x), std::max(bounds.maxY, p.y)};
+        }
+        return bounds;
+    }
+
+    void cullEdges()
+    {
+        const sf::Color overlayColor(255, 0, 0, 128);
+        edgeVertices.clear();
+        weatherVertices.clear();
+        minorEdges.clear();
+        // Weather-affected and critical edges are always shown, however short.
+        for (int e : majorEdges)
+        {
+            sf::Vector2f a = positions[edges[e].first], b = positions[edges[e].second];
+            if (!boxAround(a.x, a.y, b.x, b.y).intersects(area))
+            continue;
+            appendEdge(e);
+            if (edgeBad[e])
+            {
+                weatherVertices.push_back(sf::Vertex(a, overlayColor));
+                weatherVertices.push_back(sf::Vertex(b, overlayColor));
+            }
+        }
+        // The other open ones are dropped in regions smaller than
+        // kMinEdgePixels, where they are too short to see, and thinned to fit
+        // the budget.
+        edgeTree.aggregate(
+            area, kMinEdgePixels / scale,
+            [&](int e)
+            {
+                if (edgeMinor[e])
+                minorEdges.push_back(e);
+            },
+            [](float, float, int) {});
+        std::size_t stride = (minorEdges.size() + kEdgeBudget - 1) / kEdgeBudget;
+        for (std::size_t i = 0; i < minorEdges.size(); i += std::max<std::size_t>(stride, 1))
+        appendEdge(minorEdges[i]);
+        upload(edgeBuffer, edgeVertices);
+        upload(weatherBuffer, weatherVertices);
+    }
+
+    static std::uint64_t edgeKey(int u, int v)
+    {
+        return (std::uint64_t(std::uint32_t(std::min(u, v))) << 32) | std::uint32_t(std::max(u, v));
+    }
+
+    void recolor()
+    {
+        const sf::Color goodColor(100, 255, 100);
+        const sf::Color badColor(255, 80, 80);
+        const sf::Color closedColor(150, 150, 150);
+        const sf::Color coldColor(40, 60, 160);
+        const sf::Color warmColor(255, 220, 0);
+        const sf::Color hotColor(255, 40, 0);
+        auto mix = [](sf::Color a, sf::Color b, float t)
+        {
+            return sf::Color(a.r + (b.r - a.r) * t, a.g + (b.g - a.g) * t, a.b + (b.b - a.b) * t);
+        };
+
+        edgeColors.resize(edges.size());
+        edgeMinor.resize(edges.size());
+        majorEdges.clear();
+        for (std::size_t e = 0; e < edges.size(); ++e)
+        {
+            float heat = edgeHeat.empty() ? 0 : edgeHeat[e];
+            if (!edgeOpen[e])
+            edgeColors[e] = edgeBad[e] ? badColor : closedColor;
+            else if (edgeHeat.empty())
+            edgeColors[e] = goodColor;
+            else
+            edgeColors[e] = heat < 0.5f ? mix(coldColor, warmColor, heat * 2) : mix(warmColor, hotColor, heat * 2 - 1);
+            // Dropped when short and thinned when over budget: open
+            // good-weather edges, unless critical.
+            edgeMinor[e] = edgeOpen[e] && !edgeBad[e] && heat < 0.25f;
+            if (!edgeMinor[e])
+            majorEdges.push_back(static_cast<int>(e));
+        }
+        viewDirty = true;
+    }
+
+    void appendEdge(int e)
+    {
+        edgeVertices.push_back(sf::Vertex(positions[edges[e].first], edgeColors[e]));
+        edgeVertices.push_back(sf::Vertex(positions[edges[e].second], edgeColors[e]));
+    }
+
+    void cullAirports()
+    {
+        shownAirports.clear();
+        clusters.clear();
+        airportTree.aggregate(
+            area, kClusterPixels / scale, [&](int i) { shownAirports.push_back(i); },
+            [&](float x, float y, int count) { clusters.push_back({{x, y}, count}); });
+        buildMarkers();
+    }
+
+    // Markers are triangle fans flattened to triangles, centred where an
+    // sf::CircleShape placed at the airport position would be. A cluster
+    // keeps its on-screen size whatever the zoom and grows with its count.
+    void buildMarkers()
+    {
+        markerVertices.clear();
+        for (int i : shownAirports)
+        appendMarker(positions[i], kMarkerRadius, markerColors[i]);
+        for (const Cluster &cluster : clusters)
+        {
+            float radius = (3 + std::min(5.0f, std::log2(float(cluster.count)))) / scale;
+            appendMarker(cluster.centre, radius, defaultMarkerColor);
+        }
+        upload(markerBuffer, markerVertices);
+        markersDirty = false;
+    }
+
+    void appendMarker(sf::Vector2f position, float radius, sf::Color color)
+    {
+        sf::Vector2f centre = position + sf::Vector2f(kMarkerRadius, kMarkerRadius);
+        for (int k = 0; k < kMarkerSegments; ++k)
+        {
+            float a0 = 2 * 3.14159265f * k / kMarkerSegments;
+            float a1 = 2 * 3.14159265f * (k + 1) / kMarkerSegments;
+            markerVertices.push_back(sf::Vertex(centre, color));
+            markerVertices.push_back(sf::Vertex(centre + radius * sf::Vector2f(std::cos(a0), std::sin(a0)), color));
+            markerVertices.push_back(sf::Vertex(centre + radius * sf::Vector2f(std::cos(a1), std::sin(a1)), color));
+        }
+    }
+
+    void upload(sf::VertexBuffer &buffer, const std::vector<sf::Vertex> &vertices)
+    {
+        if (!gpu || vertices.empty())
+        return;
+        if (buffer.getVertexCount() < vertices.size())
+        buffer.create(vertices.size());
+        buffer.update(vertices.data(), vertices.size(), 0);
+    }
+
+    void draw(sf::RenderTarget &target, const sf::VertexBuffer &buffer, const std::vector<sf::Vertex> &vertices,
+              sf::PrimitiveType type)
+    {
+        if (vertices.empty())
+        return;
+        if (gpu)
+        target.draw(buffer, 0, vertices.size());
+        else
+        target.draw(vertices.data(), vertices.size(), type);
+    }
+
+    bool gpu;
+    std::vector<sf::Vector2f> positions;
+    std::vector<std::pair<int, int>> edges;
+    std::vector<sf::Color> edgeColors;
+    std::vector<char> edgeBad;
+    std::vector<char> edgeOpen;
+    std::vector<char> edgeMinor;
+    std::vector<float> edgeHeat;
+    std::unordered_map<std::uint64_t, std::size_t> edgeIndex;
+    std::vector<sf::Color> markerColors;
+    QuadTree airportTree;
+    QuadTree edgeTree;
+
+    Box area = {0, 0, 0, 0};
+    float scale = 0;
+    bool viewDirty = true;
+    bool markersDirty = false;
+    std::vector<int> shownAirports;
+    std::vector<int> majorEdges;
+    std::vector<int> minorEdges;
+    std::vector<Cluster> clusters;
+    std::vector<sf::Vertex> edgeVertices;
+    std::vector<sf::Vertex> weatherVertices;
+    std::vector<sf::Vertex> markerVertices;
+    sf::VertexBuffer edgeBuffer;
+    sf::VertexBuffer weatherBuffer;
+    sf::VertexBuffer markerBuffer;
+    sf::Color defaultMarkerColor;
+};
+
+// Airport labels drawn as one textured triangle array from the font's glyph
+// page instead of one sf::Text (and one draw call) per label. Labels keep
+// their pixel size at any zoom. Where two would overlap on screen the one
+// with the higher priority wins: labels are placed in priority order and
+// each is checked only against those already placed in the kCellPixels grid
+// cells it covers. A layout covers the view plus one view size on every
+// side, so panning reuses it until the view leaves that area; otherwise it
+// is only redone on a zoom or when labels or priorities change.
+class LabelLayer
+{
+public:
+    static constexpr float kCellPixels = 64;
+    static constexpr float kGapPixels = 4;
+
+    explicit LabelLayer(const sf::Font &font, unsigned characterSize = 14, sf::Color color = sf::Color::White)
+        : font(font), characterSize(characterSize), color(color)
+    {
+    }
+
+    // Replaces the labels. Each is drawn vertically centred on its anchor (in
+    // map coordinates) and starting just right of it.
+    void setLabels(const std::vector<sf::Vector2f> &labelAnchors, const std::vector<std::string> &texts,
+                   const std::vector<float> &labelPriorities)
+    {
+        anchors = labelAnchors;
+        priorities = labelPriorities;
+        glyphs.clear();
+        firstGlyph.assign(1, 0);
+        widths.clear();
+        // Glyph quads are laid out once here, in pixels relative to the anchor.
+        lineHeight = font.getLineSpacing(characterSize);
+        float baseline = characterSize - lineHeight / 2;
+        for (const std::string &text : texts)
+        {
+            sf::String codepoints = sf::String::fromUtf8(text.begin(), text.end());
+            float x = kGapPixels;
+            std::uint32_t previous = 0;
+            for (std::size_t i = 0; i < codepoints.getSize(); ++i)
+            {
+                std::uint32_t c = codepoints[i];
+                x += font.getKerning(previous, c, characterSize);
+                previous = c;
+                const sf::Glyph &glyph = font.getGlyph(c, characterSize, false);
+                if (glyph.bounds.width > 0 && glyph.bounds.height > 0)
+                glyphs.push_back({sf::FloatRect(x + glyph.bounds.left, baseline + glyph.bounds.top, glyph.bounds.width,
+                                                glyph.bounds.height),
+                                  glyph.textureRect});
+                x += glyph.advance;
+            }
+            firstGlyph.push_back(glyphs.size());
+            widths.push_back(x);
+        }
+
+        Box bounds = {0, 0, 1, 1};
+        for (sf::Vector2f anchor : anchors)
+        bounds = {std::min(bounds.minX, anchor.x), std::min(bounds.minY, anchor.y), std::max(bounds.maxX, anchor.x),
+                  std::max(bounds.maxY, anchor.y)};
+        tree = QuadTree(bounds);
+        for (std::size_t i = 0; i < anchors.size(); ++i)
+        tree.insert(i, boxAround(anchors[i].x, anchors[i].y, anchors[i].x, anchors[i].y));
+        dirty = true;
+    }
+
+    void setPriority(int label, float priority)
+    {
+        if (priorities[label] == priority)
+        return;
+        priorities[label] = priority;
+        dirty = true;
+    }
+
+    // Lays the labels out for `view` at `pixelsPerUnit` screen pixels per
+    // map unit, unless the current layout still covers it.
+    void setView(const sf::View &view, float pixelsPerUnit)
+    {
+        sf::Vector2f centre = view.getCenter(), size = view.getSize();
+        Box visible = {centre.x - size.x / 2, centre.y - size.y / 2, centre.x + size.x / 2, centre.y + size.y / 2};
+        if (!dirty && pixelsPerUnit == scale && area.contains(visible))
+        return;
+        area = {centre.x - size.x * 1.5f, centre.y - size.y * 1.5f, centre.x + size.x * 1.5f, centre.y + size.y * 1.5f};
+        scale = pixelsPerUnit;
+        dirty = false;
+        layout();
+    }
+
+    // Draws under the map view.
+    void draw(sf::RenderTarget &target) const
+    {
+        if (vertices.empty())
+        return;
+        sf::RenderStates states(&font.getTexture(characterSize));
+        target.draw(vertices.data(), vertices.size(), sf::Triangles, states);
+    }
+
+    // Labels that survived collision culling in the current layout.
+    std::size_t shownCount() const { return placed.size(); }
+
+private:
+    struct GlyphQuad
+    {
+        sf::FloatRect bounds;
+        sf::IntRect texture;
+    };
+
+    void layout()
+    {
+        candidates.clear();
+        tree.query(area, [&](int i) { candidates.push_back(i); });
+        std::sort(candidates.begin(), candidates.end(), [&](int a, int b)
+                  { return priorities[a] > priorities[b] || (priorities[a] == priorities[b] && a < b); });
+
+        vertices.clear();
+        placed.clear();
+        cells.clear();
+        float unit = 1 / scale;
+        for (int i : candidates)
+        {
+            sf::FloatRect box(anchors[i].x * scale, anchors[i].y * scale - lineHeight / 2, widths[i], lineHeight);
+            auto x0 = static_cast<std::int32_t>(std::floor(box.left / kCellPixels));
+            auto x1 = static_cast<std::int32_t>(std::floor((box.left + box.width) / kCellPixels));
+            auto y0 = static_cast<std::int32_t>(std::floor(box.top / kCellPixels));
+            auto y1 = static_cast<std::int32_t>(std::floor((box.top + box.height) / kCellPixels));
+            bool collides = false;
+            for (std::int32_t cy = y0; cy <= y1 && !collides; ++cy)
+            for (std::int32_t cx = x0; cx <= x1 && !collides; ++cx)
+            {
+                auto cell = cells.find(cellKey(cx, cy));
+                if (cell != cells.end())
+                for (int other : cell->second)
+                if (placed[other].intersects(box))
+                {
+                    collides = true;
+                    break;
+                }
+            }
+            if (collides)
+            continue;
+
+            for (std::int32_t cy = y0; cy <= y1; ++cy)
+            for (std::int32_t cx = x0; cx <= x1; ++cx)
+            cells[cellKey(cx, cy)].push_back(placed.size());
+            placed.push_back(box);
+
+            for (std::size_t g = firstGlyph[i]; g < firstGlyph[i + 1]; ++g)
+            {
+                const GlyphQuad &glyph = glyphs[g];
+                sf::Vector2f topLeft = anchors[i] + sf::Vector2f(glyph.bounds.left, glyph.bounds.top) * unit;
+                sf::Vector2f bottomRight = topLeft + sf::Vector2f(glyph.bounds.width, glyph.bounds.height) * unit;
+                float u0 = glyph.texture.left, v0 = glyph.texture.top;
+                float u1 = u0 + glyph.texture.width, v1 = v0 + glyph.texture.height;
+                vertices.push_back(sf::Vertex(topLeft, color, {u0, v0}));
+                vertices.push_back(sf::Vertex({bottomRight.x, topLeft.y}, color, {u1, v0}));
+                vertices.push_back(sf::Vertex({topLeft.x, bottomRight.y}, color, {u0, v1}));
+                vertices.push_back(sf::Vertex({topLeft.x, bottomRight.y}, color, {u0, v1}));
+                vertices.push_back(sf::Vertex({bottomRight.x, topLeft.y}, color, {u1, v0}));
+                vertices.push_back(sf::Vertex(bottomRight, color, {u1, v1}));
+            }
+        }
+    }
+
+    static std::uint64_t cellKey(std::int32_t x, std::int32_t y)
+    {
+        return (std::uint64_t(std::uint32_t(x)) << 32) | std::uint32_t(y);
+    }
+
+    const sf::Font &font;
+    unsigned characterSize;
+    sf::Color color;
+    float lineHeight = 0;
+
+    std::vector<sf::Vector2f> anchors;
+    std::vector<float> priorities;
+    std::vector<GlyphQuad> glyphs;
+    std::vector<std::size_t> firstGlyph = {0};
+    std::vector<float> widths;
+    QuadTree tree = QuadTree({0, 0, 1, 1});
+
+    Box area = {0, 0, 0, 0};
+    float scale = 0;
+    bool dirty = true;
+    std::vector<int> candidates;
+    std::vector<sf::FloatRect> placed;
+    std::unordered_map<std::uint64_t, std::vector<int>> cells;
+    std::vector<sf::Vertex> vertices;
+};
+
+// Labels every airport with its name or code. Busier airports (more routes)
+// get a higher priority, so hubs keep their labels when zoomed out.
+inline void labelAirports(LabelLayer &labels, const FlightGraph &graph, bool names)
+{
+    std::vector<sf::Vector2f> anchors;
+    std::vector<std::string> texts;
+    std::vector<float> priorities;
+    for (std::size_t i = 0; i < graph.airports.size(); ++i)
+    {
+        anchors.push_back(NetworkBatch::labelAnchor(graph.airports[i].position));
+        texts.emplace_back(names ? graph.airportName(i) : graph.airportCode(i));
+        priorities.push_back(graph.adj[i].size());
+    }
+    labels.setLabels(anchors, texts, priorities);
+}
+
+// Rebuilds `out` as one small arrowhead per aircraft in view, pointing along
+// its heading and the same size on screen at any zoom.
+inline void buildAircraftVertices(sf::VertexArray &out, const FleetAnimation &fleet, const MapCamera &camera,
+                                  float pixelsPerUnit, sf::Color color = sf::Color::White)
+{
+    float unit = 1 / pixelsPerUnit;
+    const std::vector<float> &x = fleet.x(), &y = fleet.y();
+    const std::vector<float> &hx = fleet.headingX(), &hy = fleet.headingY();
+    out.setPrimitiveType(sf::Triangles);
+    out.clear();
+    for (std::size_t i = 0; i < fleet.size(); ++i)
+    {
+        sf::Vector2f position(x[i], y[i]);
+        if (!camera.contains(position))
+        continue;
+        sf::Vector2f forward(hx[i] * unit, hy[i] * unit);
+        sf::Vector2f side(-forward.y, forward.x);
+        out.append(sf::Vertex(position + 6.0f * forward, color));
+        out.append(sf::Vertex(position - 4.0f * forward + 3.5f * side, color));
+        out.append(sf::Vertex(position - 4.0f * forward - 3.5f * side, color));
+    }
+}
+
+#endif
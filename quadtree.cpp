@@ -0,0 +1,82 @@
+#include "quadtree.h"
+using namespace std;
+
+QuadTree::QuadTree(const Box &bounds, int maxDepth, int leafCapacity)
+    : maxDepth(maxDepth), leafCapacity(leafCapacity)
+{
+    nodes.emplace_back();
+    nodes[0].bounds = bounds;
+}
+
+int QuadTree::childFor(int node, const Box &box) const
+{
+    int first = nodes[node].firstChild;
+    if (first < 0)
+    return -1;
+    for (int c = 0; c < 4; ++c)
+    if (nodes[first + c].bounds.contains(box))
+    return first + c;
+    return -1;
+}
+
+void QuadTree::insert(int id, const Box &box)
+{
+    float centreX = (box.minX + box.maxX) / 2;
+    float centreY = (box.minY + box.maxY) / 2;
+    int node = 0;
+    for (;;)
+    {
+        nodes[node].total += 1;
+        nodes[node].sumX += centreX;
+        nodes[node].sumY += centreY;
+        int child = childFor(node, box);
+        if (child < 0)
+        break;
+        node = child;
+    }
+
+    nodes[node].items.push_back({id, box});
+    if (nodes[node].firstChild < 0 && nodes[node].items.size() > leafCapacity && nodes[node].depth < maxDepth)
+    split(node);
+}
+
+void QuadTree::split(int node)
+{
+    const Box bounds = nodes[node].bounds;
+    float midX = (bounds.minX + bounds.maxX) / 2;
+    float midY = (bounds.minY + bounds.maxY) / 2;
+    int first = nodes.size();
+    nodes[node].firstChild = first;
+    const Box quarters[4] = {{bounds.minX, bounds.minY, midX, midY},
+                             {midX, bounds.minY, bounds.maxX, midY},
+                             {bounds.minX, midY, midX, bounds.maxY},
+                             {midX, midY, bounds.maxX, bounds.maxY}};
+    for (const Box &quarter : quarters)
+    {
+        Node child;
+        child.bounds = quarter;
+        child.depth = nodes[node].depth + 1;
+        nodes.push_back(move(child));
+    }
+
+    // Push down whatever now fits in a child; long items stay here.
+    vector<Item> items;
+    items.swap(nodes[node].items);
+    for (const Item &item : items)
+    {
+        int child = childFor(node, item.box);
+        if (child < 0)
+        {
+            nodes[node].items.push_back(item);
+            continue;
+        }
+        Node &target = nodes[child];
+        target.total += 1;
+        target.sumX += (item.box.minX + item.box.maxX) / 2;
+        target.sumY += (item.box.minY + item.box.maxY) / 2;
+        target.items.push_back(item);
+    }
+    for (int c = 0; c < 4; ++c)
+    if (nodes[first + c].items.size() > leafCapacity && nodes[first + c].depth < maxDepth)
+    split(first + c);
+}
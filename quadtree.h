@@ -0,0 +1,109 @@
+#ifndef QUADTREE_H
+#define QUADTREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Axis-aligned box in map coordinates.
+struct Box
+{
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+
+    bool intersects(const Box &other) const
+    {
+        return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+    }
+    bool contains(const Box &other) const
+    {
+        return minX <= other.minX && other.maxX <= maxX && minY <= other.minY && other.maxY <= maxY;
+    }
+    float width() const { return maxX - minX; }
+    float height() const { return maxY - minY; }
+};
+
+inline Box boxAround(float x0, float y0, float x1, float y1)
+{
+    return {std::min(x0, x1), std::min(y0, y1), std::max(x0, x1), std::max(y0, y1)};
+}
+
+// Region quadtree over boxes (points are boxes of size zero). An item lives
+// in the deepest node whose region contains all of it, so airports sink to
+// the leaves while a long edge stays near the root. Each node also counts
+// the items below it and sums their centres, which lets a query summarize a
+// region too small to draw as one cluster.
+class QuadTree
+{
+public:
+    explicit QuadTree(const Box &bounds, int maxDepth = 16, int leafCapacity = 8);
+
+    void insert(int id, const Box &box);
+    std::size_t size() const { return nodes[0].total; }
+
+    // Calls visit(id) for every item whose box intersects `area`.
+    template <typename Visit>
+    void query(const Box &area, Visit &&visit) const
+    {
+        aggregate(area, 0, visit, [](float, float, int) {});
+    }
+
+    // Like query(), but a node whose region is smaller than `minSide` is
+    // reported once as cluster(centreX, centreY, count) for all the items
+    // below it instead of item by item.
+    template <typename Visit, typename Cluster>
+    void aggregate(const Box &area, float minSide, Visit &&visit, Cluster &&cluster) const
+    {
+        if (!nodes.empty())
+        walk(0, area, minSide, visit, cluster);
+    }
+
+private:
+    struct Item
+    {
+        int id;
+        Box box;
+    };
+
+    struct Node
+    {
+        Box bounds;
+        int firstChild = -1;
+        int depth = 0;
+        std::size_t total = 0;
+        double sumX = 0;
+        double sumY = 0;
+        std::vector<Item> items;
+    };
+
+    void split(int node);
+    int childFor(int node, const Box &box) const;
+
+    template <typename Visit, typename Cluster>
+    void walk(int index, const Box &area, float minSide, Visit &visit, Cluster &cluster) const
+    {
+        const Node &node = nodes[index];
+        if (node.total == 0 || !node.bounds.intersects(area))
+        return;
+        if (std::max(node.bounds.width(), node.bounds.height()) < minSide)
+        {
+            cluster(static_cast<float>(node.sumX / node.total), static_cast<float>(node.sumY / node.total),
+                    static_cast<int>(node.total));
+            return;
+        }
+        for (const Item &item : node.items)
+        if (item.box.intersects(area))
+        visit(item.id);
+        if (node.firstChild >= 0)
+        for (int c = 0; c < 4; ++c)
+        walk(node.firstChild + c, area, minSide, visit, cluster);
+    }
+
+    std::vector<Node> nodes;
+    int maxDepth;
+    std::size_t leafCapacity;
+};
+
+#endif
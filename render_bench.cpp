@@ -0,0 +1,318 @@
+// render_bench.cpp
+// Headless rendering benchmark. Draws the map (network, weather overlay,
+// airport markers and labels) plus an animated fleet into an offscreen
+// sf::RenderTexture for a fixed number of frames on a fixed 60 Hz timestep,
+// so runs are comparable however fast the machine is and need no window.
+//
+// Each frame is timed in two parts:
+//    build   advancing the fleet, culling the network to the view and
+//            rebuilding the vertex arrays (CPU)
+//    draw    clearing, drawing and display() on the render texture, then
+//            glFinish() so the GPU work is counted too (--no-finish to skip)
+// and percentiles of both and of their total are printed at the end.
+//
+// --airports 0 uses the fifteen-airport default network; any other size is a
+// random network from buildRandomNetwork. With --pan the camera sweeps and
+// zooms across the map so culling and level of detail are exercised every
+// frame; without it the view is fixed and the static layer is drawn once.
+//
+// Usage: render_bench [--airports N] [--degree N] [--aircraft N] [--frames N]
+//                     [--width PX] [--height PX] [--bad-weather FRACTION]
+//                     [--seed N] [--pan] [--no-finish] [--dump DIR]
+//                     [--dump-every N] [--csv FILE]
+
+#include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "cli_args.h"
+#include "fleet_animation.h"
+#include "flight_graph.h"
+#include "map_view.h"
+using namespace std;
+
+using SteadyClock = chrono::steady_clock;
+
+struct RenderBenchOptions
+{
+    int airports = 2000;
+    int degree = 6;
+    int aircraft = 20000;
+    int frames = 600;
+    unsigned width = 900;
+    unsigned height = 650;
+    double badWeather = 0.05;
+    unsigned seed = 42;
+    bool pan = false;
+    bool finish = true;
+    string dumpDir;
+    int dumpEvery = 60;
+    string csv;
+};
+
+struct FrameTime
+{
+    double build;
+    double draw;
+};
+
+void printUsage()
+{
+    cerr << "Usage: render_bench [--airports N] [--degree N] [--aircraft N] [--frames N] [--width PX]"
+            " [--height PX] [--bad-weather FRACTION] [--seed N] [--pan] [--no-finish] [--dump DIR]"
+            " [--dump-every N] [--csv FILE]" << endl;
+}
+
+bool parseOptions(int argc, char *argv[], RenderBenchOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--airports" && i + 1 < argc)
+        options.airports = parseArg<int>(arg, argv[++i]);
+        else if (arg == "--degree" && i + 1 < argc)
+        options.degree = parseArg<int>(arg, argv[++i]);
+        else if (arg == "--aircraft" && i + 1 < argc)
+        options.aircraft = parseArg<int>(arg, argv[++i]);
+        else if (arg == "--frames" && i + 1 < argc)
+        options.frames = parseArg<int>(arg, argv[++i]);
+        else if (arg == "--width" && i + 1 < argc)
+        options.width = parseArg<unsigned>(arg, argv[++i]);
+        else if (arg == "--height" && i + 1 < argc)
+        options.height = parseArg<unsigned>(arg, argv[++i]);
+        else if (arg == "--bad-weather" && i + 1 < argc)
+        options.badWeather = parseArg<double>(arg, argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc)
+        options.seed = parseArg<unsigned>(arg, argv[++i]);
+        else if (arg == "--pan")
+        options.pan = true;
+        else if (arg == "--no-finish")
+        options.finish = false;
+        else if (arg == "--dump" && i + 1 < argc)
+        options.dumpDir = argv[++i];
+        else if (arg == "--dump-every" && i + 1 < argc)
+        options.dumpEvery = parseArg<int>(arg, argv[++i]);
+        else if (arg == "--csv" && i + 1 < argc)
+        options.csv = argv[++i];
+        else
+        {
+            cerr << "Unknown argument: " << arg << endl;
+            printUsage();
+            return false;
+        }
+    }
+    return options.airports >= 0 && options.degree > 0 && options.aircraft >= 0 && options.frames > 0 &&
+           options.width > 0 && options.height > 0 && options.dumpEvery > 0;
+}
+
+// Gives `count` aircraft routes between random airport pairs. Searching a
+// pair per aircraft would dominate start-up, so a pool of at most 1000 routes
+// is searched once and shared.
+void addTraffic(FleetAnimation &fleet, const FlightGraph &graph, int count, mt19937 &rng)
+{
+    int n = graph.airports.size();
+    if (n < 2 || count == 0)
+    return;
+    SearchWorkspace workspace;
+    vector<vector<Vec2>> routes;
+    for (int attempt = 0; attempt < 4000 && routes.size() < size_t(min(count, 1000)); ++attempt)
+    {
+        int src = rng() % n;
+        int dst = (src + 1 + rng() % (n - 1)) % n;
+        vector<int> path = graph.dijkstra(src, dst, [&](int u, int v)
+                                          { return graph.available(u, v) && !graph.isBad(u, v); }, workspace);
+        if (path.size() < 2)
+        continue;
+        vector<Vec2> route;
+        for (int airport : path)
+        route.push_back(graph.airports[airport].position);
+        routes.push_back(move(route));
+    }
+    if (routes.empty())
+    return;
+    uniform_real_distribution<float> speed(40, 120);
+    uniform_real_distribution<float> phase(0, 1);
+    for (int i = 0; i < count; ++i)
+    fleet.addFlight(routes[i % routes.size()], speed(rng), phase(rng));
+}
+
+int main(int argc, char *argv[])
+{
+    RenderBenchOptions options;
+    try
+    {
+        if (!parseOptions(argc, argv, options))
+        return 1;
+    }
+    catch (const invalid_argument &e)
+    {
+        cerr << e.what() << endl;
+        printUsage();
+        return 1;
+    }
+
+    mt19937 rng(options.seed);
+    FlightGraph graph;
+    if (options.airports == 0)
+    buildDefaultNetwork(graph);
+    else
+    buildRandomNetwork(graph, options.airports, options.degree, options.seed, options.width, options.height);
+    int n = graph.airports.size();
+
+    size_t edgeCount = 0;
+    for (int u = 0; u < n; ++u)
+    for (auto [v, w] : graph.adj[u])
+    if (u < v)
+    {
+        ++edgeCount;
+        if (generate_canonical<double, 32>(rng) < options.badWeather)
+        graph.updateWeather(u, v, true, "Storm");
+    }
+
+    FleetAnimation fleet;
+    addTraffic(fleet, graph, options.aircraft, rng);
+
+    sf::RenderTexture target;
+    sf::RenderTexture staticLayer;
+    if (!target.create(options.width, options.height) || !staticLayer.create(options.width, options.height))
+    {
+        cerr << "Cannot create a " << options.width << "x" << options.height << " render texture" << endl;
+        return 1;
+    }
+    sf::Sprite staticSprite(staticLayer.getTexture());
+
+    NetworkBatch network(graph, sf::Color(50, 120, 250));
+    MapCamera camera(target);
+    sf::Font font;
+    bool fontLoaded = font.loadFromFile("default.ttf");
+    if (!fontLoaded)
+    cerr << "default.ttf not found, drawing without labels" << endl;
+    LabelLayer labels(font);
+    if (fontLoaded)
+    labelAirports(labels, graph, false);
+    auto drawStatic = [&](sf::RenderTarget &layer)
+    {
+        layer.setView(camera.view);
+        network.drawEdges(layer);
+        network.drawMarkers(layer);
+        labels.draw(layer);
+        layer.setView(layer.getDefaultView());
+    };
+
+    cout << "Rendering " << options.frames << " frames at " << options.width << "x" << options.height << ": " << n
+         << " airports, " << edgeCount << " routes, " << fleet.size() << " aircraft"
+         << (options.pan ? ", panning" : "") << (sf::VertexBuffer::isAvailable() ? "" : ", no vertex buffers")
+         << endl;
+
+    const float dt = 1.0f / 60;
+    const sf::Vector2f homeCentre = camera.home.getCenter();
+    const sf::Vector2f homeSize = camera.home.getSize();
+    sf::VertexArray aircraft(sf::Triangles);
+    vector<FrameTime> times;
+    times.reserve(options.frames);
+    size_t drawnAircraft = 0;
+    int dumped = 0;
+    for (int frame = 0; frame < options.frames; ++frame)
+    {
+        auto start = SteadyClock::now();
+        fleet.update(dt);
+        bool layerDirty = frame == 0;
+        if (options.pan)
+        {
+            // A slow figure-of-eight over the map, zooming between 1x and 8x.
+            float t = frame * dt;
+            float zoom = pow(8.0f, 0.5f - 0.5f * cos(t * 0.4f));
+            camera.view.setSize(homeSize / zoom);
+            camera.view.setCenter(homeCentre + sf::Vector2f(homeSize.x * 0.35f * sin(t * 0.3f),
+                                                             homeSize.y * 0.35f * sin(t * 0.6f)));
+            layerDirty = true;
+        }
+        float scale = camera.pixelsPerUnit(target);
+        if (layerDirty)
+        {
+            network.setView(camera.view, scale);
+            labels.setView(camera.view, scale);
+        }
+        buildAircraftVertices(aircraft, fleet, camera, scale);
+        drawnAircraft += aircraft.getVertexCount() / 3;
+        auto built = SteadyClock::now();
+
+        if (layerDirty)
+        {
+            staticLayer.clear();
+            drawStatic(staticLayer);
+            staticLayer.display();
+        }
+        target.clear();
+        target.draw(staticSprite);
+        target.setView(camera.view);
+        target.draw(aircraft);
+        target.setView(target.getDefaultView());
+        target.display();
+        if (options.finish)
+        glFinish();
+        auto drawn = SteadyClock::now();
+
+        times.push_back({chrono::duration<double, milli>(built - start).count(),
+                         chrono::duration<double, milli>(drawn - built).count()});
+
+        if (!options.dumpDir.empty() && frame % options.dumpEvery == 0)
+        {
+            char name[32];
+            snprintf(name, sizeof name, "/frame_%05d.png", frame);
+            if (!target.getTexture().copyToImage().saveToFile(options.dumpDir + name))
+            {
+                cerr << "Cannot write frames to " << options.dumpDir << ", dumping stopped" << endl;
+                options.dumpDir.clear();
+            }
+            else
+            ++dumped;
+        }
+    }
+
+    if (!options.csv.empty())
+    {
+        ofstream csv(options.csv);
+        if (!csv)
+        {
+            cerr << "Cannot write " << options.csv << endl;
+            return 1;
+        }
+        csv << "frame,build_ms,draw_ms,total_ms\n";
+        for (size_t i = 0; i < times.size(); ++i)
+        csv << i << ',' << times[i].build << ',' << times[i].draw << ',' << times[i].build + times[i].draw << '\n';
+    }
+
+    auto report = [&](const char *name, auto value)
+    {
+        vector<double> sorted;
+        for (const FrameTime &time : times)
+        sorted.push_back(value(time));
+        sort(sorted.begin(), sorted.end());
+        double mean = 0;
+        for (double ms : sorted)
+        mean += ms;
+        mean /= sorted.size();
+        auto percentile = [&](double p) { return sorted[size_t(p * (sorted.size() - 1))]; };
+        printf("  %-6s mean %8.3f  p50 %8.3f  p90 %8.3f  p99 %8.3f  max %8.3f ms\n", name, mean, percentile(0.5),
+               percentile(0.9), percentile(0.99), percentile(1));
+    };
+    cout << "Frame times:" << endl;
+    report("build", [](const FrameTime &time) { return time.build; });
+    report("draw", [](const FrameTime &time) { return time.draw; });
+    report("total", [](const FrameTime &time) { return time.build + time.draw; });
+    cout << "Aircraft drawn per frame: " << drawnAircraft / options.frames << " of " << fleet.size() << endl;
+    if (dumped)
+    cout << dumped << " frames written to " << options.dumpDir << endl;
+    if (!options.csv.empty())
+    cout << "Per-frame times written to " << options.csv << endl;
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include "replacement_paths.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+using namespace std;
+
+namespace
+{
+struct ShortestPathTree
+{
+    vector<double> dist;
+    vector<int> parent;
+    // Reached nodes in the order they were settled, parents first.
+    vector<int> order;
+};
+
+ShortestPathTree growTree(const FlightGraph &graph, const vector<char> &usable, int root)
+{
+    using PDI = pair<double, int>;
+    int n = graph.adj.size();
+    ShortestPathTree tree{vector<double>(n, numeric_limits<double>::infinity()), vector<int>(n, -1), {}};
+    vector<size_t> firstArc(n + 1, 0);
+    for (int u = 0; u < n; ++u)
+    firstArc[u + 1] = firstArc[u] + graph.adj[u].size();
+    vector<char> settled(n, 0);
+    vector<PDI> heap{{0, root}};
+    tree.dist[root] = 0;
+    while (!heap.empty())
+    {
+        pop_heap(heap.begin(), heap.end(), greater<PDI>());
+        auto [d, u] = heap.back();
+        heap.pop_back();
+        if (settled[u] || d > tree.dist[u])
+        continue;
+        settled[u] = 1;
+        tree.order.push_back(u);
+        size_t arc = firstArc[u];
+        for (auto [v, w] : graph.adj[u])
+        {
+            if (!usable[arc++] || settled[v] || d + w >= tree.dist[v])
+            continue;
+            tree.dist[v] = d + w;
+            tree.parent[v] = u;
+            heap.push_back({d + w, v});
+            push_heap(heap.begin(), heap.end(), greater<PDI>());
+        }
+    }
+    return tree;
+}
+
+int findUnassigned(vector<int> &next, int i)
+{
+    while (next[i] != i)
+    {
+        next[i] = next[next[i]];
+        i = next[i];
+    }
+    return i;
+}
+} // namespace
+
+ReplacementPaths replacementPaths(const FlightGraph &graph, int src, int dst, const vector<char> &usable)
+{
+    TRACE_SCOPE("replacementPaths");
+    ReplacementPaths result;
+    ShortestPathTree fromSrc = growTree(graph, usable, src);
+    if (fromSrc.parent[dst] < 0 && src != dst)
+    return result;
+    for (int v = dst; v >= 0; v = fromSrc.parent[v])
+    result.route.push_back(v);
+    reverse(result.route.begin(), result.route.end());
+    result.distance = fromSrc.dist[dst];
+    const vector<int> &route = result.route;
+    int segments = static_cast<int>(route.size()) - 1;
+
+    // Distances to dst equal distances from it, since segments run both
+    // ways. Its tree is made to follow the route from every route airport,
+    // which is still a shortest-path tree because the route's tails are
+    // shortest, so a tree path that reaches the route stays on it.
+    ShortestPathTree toDst = growTree(graph, usable, dst);
+    for (int j = 0; j < segments; ++j)
+    toDst.parent[route[j]] = route[j + 1];
+
+    int n = graph.adj.size();
+    vector<int> leaveIndex(n, -1), joinIndex(n, -1);
+    for (int j = 0; j <= segments; ++j)
+    leaveIndex[route[j]] = joinIndex[route[j]] = j;
+    for (int v : fromSrc.order)
+    if (leaveIndex[v] < 0)
+    leaveIndex[v] = leaveIndex[fromSrc.parent[v]];
+    for (int v : toDst.order)
+    if (joinIndex[v] < 0)
+    joinIndex[v] = joinIndex[toDst.parent[v]];
+
+    // Edge x-y can replace segments leaveIndex[x] .. joinIndex[y] - 1: the
+    // src tree path to x uses none of them and the dst tree path from y
+    // neither. A route segment would only cover itself, so it is skipped.
+    struct Candidate
+    {
+        double cost;
+        int first;
+        int last;
+        int x;
+        int y;
+    };
+    vector<Candidate> candidates;
+    size_t arc = 0;
+    for (int x = 0; x < n; ++x)
+    for (auto [y, w] : graph.adj[x])
+    {
+        if (!usable[arc++] || leaveIndex[x] < 0 || joinIndex[y] <= leaveIndex[x])
+        continue;
+        int first = leaveIndex[x], last = joinIndex[y] - 1;
+        if (first == last && x == route[first] && y == route[first + 1])
+        continue;
+        candidates.push_back({fromSrc.dist[x] + w + toDst.dist[y], first, last, x, y});
+    }
+    sort(candidates.begin(), candidates.end(),
+         [](const Candidate &a, const Candidate &b) { return a.cost < b.cost; });
+
+    // Cheapest first, each segment keeps the first candidate covering it;
+    // next[] skips over segments already assigned.
+    vector<int> chosen(segments, -1);
+    vector<int> next(segments + 1);
+    iota(next.begin(), next.end(), 0);
+    for (size_t c = 0; c < candidates.size(); ++c)
+    for (int i = findUnassigned(next, candidates[c].first); i <= candidates[c].last;
+         i = findUnassigned(next, i + 1))
+    {
+        chosen[i] = static_cast<int>(c);
+        next[i] = i + 1;
+    }
+
+    result.detours.resize(segments);
+    for (int i = 0; i < segments; ++i)
+    {
+        Detour &detour = result.detours[i];
+        detour.u = route[i];
+        detour.v = route[i + 1];
+        detour.distance = numeric_limits<double>::infinity();
+        if (chosen[i] < 0)
+        continue;
+        const Candidate &best = candidates[chosen[i]];
+        detour.distance = best.cost;
+        for (int v = best.x; v >= 0; v = fromSrc.parent[v])
+        detour.path.push_back(v);
+        reverse(detour.path.begin(), detour.path.end());
+        for (int v = best.y; v >= 0; v = toDst.parent[v])
+        detour.path.push_back(v);
+    }
+    return result;
+}
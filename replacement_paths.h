@@ -0,0 +1,46 @@
+#ifndef REPLACEMENT_PATHS_H
+#define REPLACEMENT_PATHS_H
+
+#include <vector>
+#include "flight_graph.h"
+
+// Best route left when one segment of the shortest route closes.
+struct Detour
+{
+    // The closed segment, in route order.
+    int u;
+    int v;
+    // Length of the best route avoiding it; infinity if there is none.
+    double distance;
+    std::vector<int> path;
+};
+
+struct ReplacementPaths
+{
+    // Shortest route from src to dst (empty if unreachable) and its length.
+    std::vector<int> route;
+    double distance = 0;
+    // One per segment of `route`, in order.
+    std::vector<Detour> detours;
+};
+
+// Answers "what if each segment of the src -> dst route closes?" for all of
+// them at once, at the cost of about two searches instead of one per
+// segment. Full shortest-path trees are grown from src and from dst. Every
+// airport is tagged with where its tree path leaves the route: from the
+// src tree, the last route airport on the way to it; from the dst tree, the
+// first one on its way to dst. When segment i closes, an edge x-y with x
+// tagged <= i and y tagged > i gives a detour: tree path to x, the edge,
+// tree path from y. In an undirected graph with positive lengths the best
+// of these is the best route avoiding the segment. Each edge is a candidate
+// for a contiguous range of segments, so candidates are taken cheapest
+// first and each segment keeps the first one that covers it.
+ReplacementPaths replacementPaths(const FlightGraph &graph, int src, int dst, const std::vector<char> &usable);
+
+template <typename Available>
+ReplacementPaths replacementPaths(const FlightGraph &graph, int src, int dst, const Available &available)
+{
+    return replacementPaths(graph, src, dst, usableArcs(graph, available));
+}
+
+#endif
@@ -0,0 +1,762 @@
+// route_bench.cpp
+// Reproducible routing benchmark. Generates seeded synthetic networks and
+// times every routing implementation on the same query set:
+//
+//    flightgraph_dijkstra   FlightGraph::dijkstra (library, reused workspace)
+//    flightgraph_bidirectional, flightgraph_astar, flightgraph_dense_scan
+//                           the alternative strategies in route_tuner.h
+//    flightgraph_autotuned  RouteTuner choosing between them per query
+//    run_dijkstra           run_algorithms.h dijkstra (string-keyed, full SSSP)
+//    run_bellman_ford       run_algorithms.h bellmanFord
+//    run_astar              run_algorithms.h astar
+//    run_indexed_dijkstra, run_indexed_bellman_ford, run_indexed_astar
+//                           the same on a RunGraph indexed once, as the
+//                           generated simulator runs them (string-keyed rows
+//                           above are adapters that index per call)
+//
+// Generators: default (the fifteen-airport network main() builds), complete,
+// geometric (random geometric graph, average degree ~10), grid (4-neighbour
+// lattice) and scalefree (Barabasi-Albert hubs, m = 3). Edge weights are
+// never shorter than the straight-line distance, so A* stays admissible.
+//
+// Results (qps, latency percentiles, settled nodes per query, heap bytes of
+// each graph representation) are printed and written as CSV, or JSON when
+// --output ends in ".json". With --baseline, qps is compared against an
+// earlier CSV run and drops beyond 10% are flagged.
+//
+// Usage: route_bench [--generators LIST] [--sizes LIST] [--queries N] [--max-seconds S]
+//                    [--seed N] [--dense-limit N] [--complete-limit N]
+//                    [--bellman-ford-limit N] [--output FILE] [--baseline FILE]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "flight_graph.h"
+#include "route_tuner.h"
+#include "run_algorithms.h"
+using namespace std;
+
+using SteadyClock = chrono::steady_clock;
+
+struct BenchOptions
+{
+    vector<string> generators = {"default", "complete", "geometric", "grid", "scalefree"};
+    vector<long long> sizes = {100, 1000, 10000, 100000, 1000000};
+    int queries = 200;
+    double maxSeconds = 2.0;
+    unsigned seed = 42;
+    long long denseLimit = 4096;
+    long long completeLimit = 2000;
+    double bellmanFordLimit = 2e7;
+    string output = "route_bench.csv";
+    string baseline;
+};
+
+struct BenchGraph
+{
+    string generator;
+    int n = 0;
+    vector<Vec2> position;
+    vector<tuple<int, int, double>> edges;
+};
+
+struct BenchResult
+{
+    string generator;
+    int nodes = 0;
+    size_t edges = 0;
+    string algorithm;
+    string status;
+    int queries = 0;
+    double qps = 0;
+    double meanUs = 0;
+    double p50Us = 0;
+    double p99Us = 0;
+    double settled = 0;
+    long long memoryBytes = 0;
+    double buildMs = 0;
+    int mismatches = 0;
+};
+
+// Live heap bytes. The global allocator is replaced so that the memory cost
+// of each graph representation is exact and repeatable; resident set size
+// hides allocations that reuse memory freed by the previous graph. The
+// aligned forms matter too: FlightGraph's arena allocates through them.
+namespace
+{
+atomic<long long> heapBytes{0};
+
+struct BlockHeader
+{
+    void *base;
+    size_t size;
+};
+
+void *trackedAlloc(size_t size, size_t align)
+{
+    align = max(align, alignof(max_align_t));
+    char *base = static_cast<char *>(malloc(size + align + sizeof(BlockHeader)));
+    if (!base)
+    throw bad_alloc();
+    uintptr_t user = (reinterpret_cast<uintptr_t>(base) + sizeof(BlockHeader) + align - 1) & ~uintptr_t(align - 1);
+    reinterpret_cast<BlockHeader *>(user)[-1] = {base, size};
+    heapBytes.fetch_add(size, memory_order_relaxed);
+    return reinterpret_cast<void *>(user);
+}
+
+void trackedFree(void *p)
+{
+    if (!p)
+    return;
+    BlockHeader header = static_cast<BlockHeader *>(p)[-1];
+    heapBytes.fetch_sub(header.size, memory_order_relaxed);
+    free(header.base);
+}
+}
+
+void *operator new(size_t size)
+{
+    return trackedAlloc(size, 0);
+}
+
+void *operator new(size_t size, align_val_t align)
+{
+    return trackedAlloc(size, static_cast<size_t>(align));
+}
+
+void operator delete(void *p) noexcept
+{
+    trackedFree(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    trackedFree(p);
+}
+
+void operator delete(void *p, align_val_t) noexcept
+{
+    trackedFree(p);
+}
+
+void operator delete(void *p, size_t, align_val_t) noexcept
+{
+    trackedFree(p);
+}
+
+double distance(Vec2 a, Vec2 b)
+{
+    double dx = a.x - b.x, dy = a.y - b.y;
+    return sqrt(dx * dx + dy * dy);
+}
+
+BenchGraph makeDefault()
+{
+    FlightGraph graph;
+    buildDefaultNetwork(graph);
+    BenchGraph g{"default", static_cast<int>(graph.airports.size()), {}, {}};
+    for (const auto &airport : graph.airports)
+    g.position.push_back(airport.position);
+    for (int u = 0; u < g.n; ++u)
+    for (auto [v, w] : graph.adj[u])
+    if (u < v)
+    g.edges.emplace_back(u, v, w);
+    return g;
+}
+
+void randomPositions(BenchGraph &g, mt19937_64 &rng)
+{
+    uniform_real_distribution<float> coord(0, 1000);
+    g.position.resize(g.n);
+    for (auto &p : g.position)
+    p = {coord(rng), coord(rng)};
+}
+
+BenchGraph makeComplete(int n, mt19937_64 &rng)
+{
+    BenchGraph g{"complete", n, {}, {}};
+    randomPositions(g, rng);
+    g.edges.reserve(size_t(n) * (n - 1) / 2);
+    for (int u = 0; u < n; ++u)
+    for (int v = u + 1; v < n; ++v)
+    g.edges.emplace_back(u, v, distance(g.position[u], g.position[v]));
+    return g;
+}
+
+BenchGraph makeGeometric(int n, mt19937_64 &rng)
+{
+    BenchGraph g{"geometric", n, {}, {}};
+    randomPositions(g, rng);
+
+    // Radius for an expected degree of ~10, bucketed so only neighbouring
+    // cells are compared.
+    const double radius = 1000.0 * sqrt(10.0 / (M_PI * n));
+    int cells = max(1, static_cast<int>(1000.0 / radius));
+    double cellSize = 1000.0 / cells;
+    vector<vector<int>> bucket(size_t(cells) * cells);
+    auto cellOf = [&](float c) { return min(cells - 1, static_cast<int>(c / cellSize)); };
+    for (int i = 0; i < n; ++i)
+    bucket[size_t(cellOf(g.position[i].y)) * cells + cellOf(g.position[i].x)].push_back(i);
+
+    for (int u = 0; u < n; ++u)
+    {
+        int cx = cellOf(g.position[u].x), cy = cellOf(g.position[u].y);
+        for (int y = max(0, cy - 1); y <= min(cells - 1, cy + 1); ++y)
+        for (int x = max(0, cx - 1); x <= min(cells - 1, cx + 1); ++x)
+        for (int v : bucket[size_t(y) * cells + x])
+        {
+            if (v <= u)
+            continue;
+            double d = distance(g.position[u], g.position[v]);
+            if (d <= radius)
+            g.edges.emplace_back(u, v, d);
+        }
+    }
+    return g;
+}
+
+BenchGraph makeGrid(int n, mt19937_64 &rng)
+{
+    int side = max(2, static_cast<int>(lround(sqrt(double(n)))));
+    BenchGraph g{"grid", side * side, {}, {}};
+    g.position.resize(g.n);
+    const float spacing = 1000.0f / side;
+    for (int y = 0; y < side; ++y)
+    for (int x = 0; x < side; ++x)
+    g.position[y * side + x] = {x * spacing, y * spacing};
+
+    uniform_real_distribution<double> jitter(1.0, 1.5);
+    for (int y = 0; y < side; ++y)
+    for (int x = 0; x < side; ++x)
+    {
+        int u = y * side + x;
+        if (x + 1 < side)
+        g.edges.emplace_back(u, u + 1, spacing * jitter(rng));
+        if (y + 1 < side)
+        g.edges.emplace_back(u, u + side, spacing * jitter(rng));
+    }
+    return g;
+}
+
+BenchGraph makeScaleFree(int n, mt19937_64 &rng)
+{
+    const int m = 3;
+    BenchGraph g{"scalefree", max(n, m + 1), {}, {}};
+    randomPositions(g, rng);
+    uniform_real_distribution<double> stretch(1.0, 1.25);
+
+    // Preferential attachment: every edge endpoint is listed once, so a
+    // uniform pick from `endpoints` picks nodes proportionally to degree.
+    vector<int> endpoints;
+    auto connect = [&](int u, int v)
+    {
+        g.edges.emplace_back(u, v, distance(g.position[u], g.position[v]) * stretch(rng));
+        endpoints.push_back(u);
+        endpoints.push_back(v);
+    };
+    for (int u = 0; u <= m; ++u)
+    for (int v = u + 1; v <= m; ++v)
+    connect(u, v);
+
+    vector<int> targets;
+    for (int u = m + 1; u < g.n; ++u)
+    {
+        targets.clear();
+        while (static_cast<int>(targets.size()) < m)
+        {
+            int v = endpoints[rng() % endpoints.size()];
+            if (find(targets.begin(), targets.end(), v) == targets.end())
+            targets.push_back(v);
+        }
+        for (int v : targets)
+        connect(u, v);
+    }
+    return g;
+}
+
+string nodeName(int i)
+{
+    return "N" + to_string(i);
+}
+
+// Runs `query(i)` for up to options.queries queries or options.maxSeconds,
+// whichever comes first, and fills in the timing fields of `result`. `query`
+// returns the nodes it settled; `check(i)` verifies its answer off the clock.
+template <typename Query, typename Check>
+void timeQueries(const BenchOptions &options, BenchResult &result, Query &&query, Check &&check)
+{
+    vector<double> latencies;
+    double settledTotal = 0, sum = 0;
+    for (int i = 0; i < options.queries && sum < options.maxSeconds * 1e6; ++i)
+    {
+        auto t0 = SteadyClock::now();
+        settledTotal += query(i);
+        auto t1 = SteadyClock::now();
+        latencies.push_back(chrono::duration<double, micro>(t1 - t0).count());
+        sum += latencies.back();
+        check(i);
+    }
+
+    result.status = "ok";
+    result.queries = latencies.size();
+    result.qps = result.queries / (sum / 1e6);
+    result.settled = settledTotal / result.queries;
+    result.meanUs = sum / latencies.size();
+    sort(latencies.begin(), latencies.end());
+    result.p50Us = latencies[latencies.size() / 2];
+    result.p99Us = latencies[min(latencies.size() - 1, latencies.size() * 99 / 100)];
+}
+
+// Compares an algorithm's answer for query i with the first answer recorded
+// for it; unreachable pairs (infinite reference) are not compared.
+bool sameDistance(vector<double> &reference, int i, double d)
+{
+    if (std::isnan(reference[i]))
+    {
+        reference[i] = d;
+        return true;
+    }
+    if (std::isinf(reference[i]))
+    return true;
+    return fabs(reference[i] - d) <= 1e-6 * max(1.0, reference[i]);
+}
+
+vector<BenchResult> benchmarkGraph(const BenchOptions &options, const BenchGraph &g)
+{
+    vector<BenchResult> results;
+    auto makeResult = [&](const string &algorithm)
+    {
+        BenchResult r;
+        r.generator = g.generator;
+        r.nodes = g.n;
+        r.edges = g.edges.size();
+        r.algorithm = algorithm;
+        return r;
+    };
+
+    mt19937_64 rng(options.seed ^ (uint64_t(g.n) << 20));
+    vector<pair<int, int>> queries;
+    uniform_int_distribution<int> pick(0, g.n - 1);
+    for (int i = 0; i < options.queries; ++i)
+    {
+        int a = pick(rng), b = pick(rng);
+        while (b == a)
+        b = pick(rng);
+        queries.push_back({a, b});
+    }
+    vector<double> reference(queries.size(), nan(""));
+
+    // FlightGraph keeps n x n availability and weather matrices.
+    static const char *flightGraphRows[] = {"flightgraph_dijkstra", "flightgraph_bidirectional", "flightgraph_astar",
+                                            "flightgraph_dense_scan", "flightgraph_autotuned"};
+    if (g.n > options.denseLimit)
+    {
+        for (const char *name : flightGraphRows)
+        {
+            BenchResult r = makeResult(name);
+            r.status = "skipped:dense_matrix";
+            results.push_back(r);
+        }
+    }
+    else
+    {
+        long long before = heapBytes.load();
+        auto t0 = SteadyClock::now();
+        auto graph = make_unique<FlightGraph>();
+        graph->reserveAirports(g.n);
+        for (int i = 0; i < g.n; ++i)
+        {
+            string name = nodeName(i);
+            graph->addAirport(name, name, g.position[i].x, g.position[i].y);
+        }
+        for (auto [u, v, w] : g.edges)
+        graph->addEdge(u, v, w);
+        double buildMs = chrono::duration<double, milli>(SteadyClock::now() - t0).count();
+        long long memoryBytes = heapBytes.load() - before;
+
+        GraphProfile profile = profileGraph(*graph);
+        RouteTuner tuner(*graph, profile);
+        RouteWorkspace rw;
+        for (int row = 0; row < 5; ++row)
+        {
+            BenchResult r = makeResult(flightGraphRows[row]);
+            r.buildMs = buildMs;
+            r.memoryBytes = memoryBytes;
+            vector<int> path;
+            timeQueries(options, r, [&](int i)
+            {
+                auto available = [&](int u, int v) { return graph->available(u, v); };
+                int src = queries[i].first, dst = queries[i].second;
+                switch (row)
+                {
+                case 0:
+                    path = graph->dijkstra(src, dst, available, rw.forward);
+                    break;
+                case 1:
+                    path = bidirectionalDijkstra(*graph, src, dst, available, rw);
+                    break;
+                case 2:
+                    path = astarSearch(*graph, src, dst, available, profile.heuristicScale, rw);
+                    break;
+                case 3:
+                    path = denseScanDijkstra(*graph, src, dst, available, rw);
+                    break;
+                default:
+                    path = tuner.route(src, dst, available);
+                    return double(tuner.workspace().settled);
+                }
+                // Counted by the searches themselves, as run_algorithms.h
+                // counts its own.
+                return double(rw.forward.settled);
+            }, [&](int i)
+            {
+                double d = path.empty() ? numeric_limits<double>::infinity() : graph->pathLength(path);
+                r.mismatches += !sameDistance(reference, i, d);
+            });
+            results.push_back(r);
+        }
+    }
+
+    // The run.cpp algorithms share one string-keyed graph.
+    long long before = heapBytes.load();
+    auto t0 = SteadyClock::now();
+    auto graph = make_unique<StringGraph>();
+    unordered_map<string, pair<double, double>> coords;
+    vector<string> names(g.n);
+    graph->reserve(g.n);
+    for (int i = 0; i < g.n; ++i)
+    {
+        names[i] = nodeName(i);
+        (*graph)[names[i]];
+        coords[names[i]] = {g.position[i].x, g.position[i].y};
+    }
+    for (auto [u, v, w] : g.edges)
+    {
+        (*graph)[names[u]].push_back({names[v], w});
+        (*graph)[names[v]].push_back({names[u], w});
+    }
+    double buildMs = chrono::duration<double, milli>(SteadyClock::now() - t0).count();
+    long long memoryBytes = heapBytes.load() - before;
+
+    auto pathWeight = [&](const vector<string> &path)
+    {
+        double total = 0;
+        for (size_t i = 1; i < path.size(); ++i)
+        {
+            double best = numeric_limits<double>::infinity();
+            for (auto &e : graph->at(path[i - 1]))
+            if (e.first == path[i])
+            best = min(best, e.second);
+            total += best;
+        }
+        return total;
+    };
+
+    {
+        BenchResult r = makeResult("run_dijkstra");
+        r.buildMs = buildMs;
+        r.memoryBytes = memoryBytes;
+        unordered_map<string, double> dist;
+        timeQueries(options, r, [&](int i)
+        {
+            unordered_map<string, string> prev;
+            size_t settled = 0;
+            dist = dijkstra(*graph, names[queries[i].first], prev, &settled);
+            return double(settled);
+        }, [&](int i) { r.mismatches += !sameDistance(reference, i, dist[names[queries[i].second]]); });
+        results.push_back(r);
+    }
+
+    {
+        BenchResult r = makeResult("run_bellman_ford");
+        r.buildMs = buildMs;
+        r.memoryBytes = memoryBytes;
+        if (double(g.n) * 2 * g.edges.size() > options.bellmanFordLimit)
+        r.status = "skipped:too_slow";
+        else
+        {
+            unordered_map<string, double> dist;
+            timeQueries(options, r, [&](int i)
+            {
+                unordered_map<string, string> prev;
+                dist = bellmanFord(*graph, names[queries[i].first], prev);
+                return double(g.n);
+            }, [&](int i) { r.mismatches += !sameDistance(reference, i, dist[names[queries[i].second]]); });
+        }
+        results.push_back(r);
+    }
+
+    {
+        BenchResult r = makeResult("run_astar");
+        r.buildMs = buildMs;
+        r.memoryBytes = memoryBytes;
+        vector<string> path;
+        timeQueries(options, r, [&](int i)
+        {
+            size_t settled = 0;
+            path = astar(*graph, names[queries[i].first], names[queries[i].second], coords, &settled);
+            return double(settled);
+        }, [&](int i)
+        {
+            if (!std::isinf(reference[i]))
+            r.mismatches += !sameDistance(reference, i, pathWeight(path));
+        });
+        results.push_back(r);
+    }
+
+    // The integer-ID rows index the string graph once, as the generated
+    // simulator does, and count that toward build time and memory.
+    before = heapBytes.load();
+    t0 = SteadyClock::now();
+    RunGraph run = indexRunGraph(*graph, coords);
+    double indexMs = buildMs + chrono::duration<double, milli>(SteadyClock::now() - t0).count();
+    long long indexBytes = memoryBytes + heapBytes.load() - before;
+    vector<int> ids(g.n);
+    for (int i = 0; i < g.n; ++i)
+    ids[i] = run.nodes.id(names[i]);
+    SearchBuffers buffers;
+
+    {
+        BenchResult r = makeResult("run_indexed_dijkstra");
+        r.buildMs = indexMs;
+        r.memoryBytes = indexBytes;
+        timeQueries(options, r, [&](int i)
+        {
+            size_t settled = 0;
+            dijkstra(run, ids[queries[i].first], buffers, &settled);
+            return double(settled);
+        }, [&](int i) { r.mismatches += !sameDistance(reference, i, buffers.dist[ids[queries[i].second]]); });
+        results.push_back(r);
+    }
+
+    {
+        BenchResult r = makeResult("run_indexed_bellman_ford");
+        r.buildMs = indexMs;
+        r.memoryBytes = indexBytes;
+        if (double(g.n) * 2 * g.edges.size() > options.bellmanFordLimit)
+        r.status = "skipped:too_slow";
+        else
+        timeQueries(options, r, [&](int i)
+        {
+            bellmanFord(run, ids[queries[i].first], buffers);
+            return double(g.n);
+        }, [&](int i) { r.mismatches += !sameDistance(reference, i, buffers.dist[ids[queries[i].second]]); });
+        results.push_back(r);
+    }
+
+    {
+        BenchResult r = makeResult("run_indexed_astar");
+        r.buildMs = indexMs;
+        r.memoryBytes = indexBytes;
+        vector<int> path;
+        timeQueries(options, r, [&](int i)
+        {
+            size_t settled = 0;
+            path = astar(run, ids[queries[i].first], ids[queries[i].second], buffers, &settled);
+            return double(settled);
+        }, [&](int i)
+        {
+            if (!std::isinf(reference[i]))
+            r.mismatches += !sameDistance(reference, i, buffers.dist[ids[queries[i].second]]);
+        });
+        results.push_back(r);
+    }
+    return results;
+}
+
+vector<string> splitList(const string &s)
+{
+    vector<string> items;
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ','))
+    if (!item.empty())
+    items.push_back(item);
+    return items;
+}
+
+string resultKey(const string &generator, long long nodes, const string &algorithm)
+{
+    return generator + "/" + to_string(nodes) + "/" + algorithm;
+}
+
+// Reads qps per (generator, nodes, algorithm) from an earlier CSV run.
+map<string, double> readBaseline(const string &path)
+{
+    map<string, double> qps;
+    ifstream in(path);
+    string line;
+    getline(in, line);
+    while (getline(in, line))
+    {
+        vector<string> fields;
+        stringstream ss(line);
+        string field;
+        while (getline(ss, field, ','))
+        fields.push_back(field);
+        if (fields.size() >= 7 && fields[4] == "ok")
+        qps[resultKey(fields[0], stoll(fields[1]), fields[3])] = stod(fields[6]);
+    }
+    return qps;
+}
+
+bool writeResults(const string &path, const vector<BenchResult> &results, const BenchOptions &options)
+{
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f)
+    return false;
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    if (json)
+    fprintf(f, "{\"seed\":%u,\"results\":[\n", options.seed);
+    else
+    fprintf(f, "generator,nodes,edges,algorithm,status,queries,qps,mean_us,p50_us,p99_us,settled_avg,memory_bytes,build_ms,mismatches\n");
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult &r = results[i];
+        if (json)
+        fprintf(f, "%s{\"generator\":\"%s\",\"nodes\":%d,\"edges\":%zu,\"algorithm\":\"%s\",\"status\":\"%s\","
+                   "\"queries\":%d,\"qps\":%.3f,\"mean_us\":%.3f,\"p50_us\":%.3f,\"p99_us\":%.3f,\"settled_avg\":%.1f,"
+                   "\"memory_bytes\":%lld,\"build_ms\":%.3f,\"mismatches\":%d}",
+                i ? ",\n" : "", r.generator.c_str(), r.nodes, r.edges, r.algorithm.c_str(), r.status.c_str(), r.queries,
+                r.qps, r.meanUs, r.p50Us, r.p99Us, r.settled, r.memoryBytes, r.buildMs, r.mismatches);
+        else
+        fprintf(f, "%s,%d,%zu,%s,%s,%d,%.3f,%.3f,%.3f,%.3f,%.1f,%lld,%.3f,%d\n",
+                r.generator.c_str(), r.nodes, r.edges, r.algorithm.c_str(), r.status.c_str(), r.queries,
+                r.qps, r.meanUs, r.p50Us, r.p99Us, r.settled, r.memoryBytes, r.buildMs, r.mismatches);
+    }
+    if (json)
+    fprintf(f, "\n]}\n");
+    return fclose(f) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (i + 1 >= argc)
+        arg = "";
+        if (arg == "--generators")
+        options.generators = splitList(argv[++i]);
+        else if (arg == "--sizes")
+        {
+            options.sizes.clear();
+            for (const string &s : splitList(argv[++i]))
+            options.sizes.push_back(static_cast<long long>(stod(s)));
+        }
+        else if (arg == "--queries")
+        options.queries = max(1, stoi(argv[++i]));
+        else if (arg == "--max-seconds")
+        options.maxSeconds = stod(argv[++i]);
+        else if (arg == "--seed")
+        options.seed = static_cast<unsigned>(stoul(argv[++i]));
+        else if (arg == "--dense-limit")
+        options.denseLimit = stoll(argv[++i]);
+        else if (arg == "--complete-limit")
+        options.completeLimit = stoll(argv[++i]);
+        else if (arg == "--bellman-ford-limit")
+        options.bellmanFordLimit = stod(argv[++i]);
+        else if (arg == "--output")
+        options.output = argv[++i];
+        else if (arg == "--baseline")
+        options.baseline = argv[++i];
+        else
+        {
+            cerr << "Usage: route_bench [--generators LIST] [--sizes LIST] [--queries N] [--max-seconds S]"
+                    " [--seed N] [--dense-limit N] [--complete-limit N] [--bellman-ford-limit N]"
+                    " [--output FILE] [--baseline FILE]" << endl;
+            return 1;
+        }
+    }
+
+    map<string, double> baseline;
+    if (!options.baseline.empty())
+    baseline = readBaseline(options.baseline);
+
+    printf("%-10s %8s %9s %-21s %9s %12s %10s %10s %11s %10s\n", "generator", "nodes", "edges", "algorithm",
+           "queries", "qps", "p50_us", "p99_us", "settled", "mem_MB");
+
+    vector<BenchResult> all;
+    int regressions = 0, mismatches = 0;
+    for (const string &generator : options.generators)
+    {
+        vector<long long> sizes = generator == "default" ? vector<long long>{15} : options.sizes;
+        for (long long n : sizes)
+        {
+            mt19937_64 rng(options.seed ^ (uint64_t(n) * 0x9E3779B97F4A7C15ull));
+            BenchGraph g;
+            if (generator == "default")
+            g = makeDefault();
+            else if (generator == "complete")
+            {
+                if (n > options.completeLimit)
+                continue;
+                g = makeComplete(n, rng);
+            }
+            else if (generator == "geometric")
+            g = makeGeometric(n, rng);
+            else if (generator == "grid")
+            g = makeGrid(n, rng);
+            else if (generator == "scalefree")
+            g = makeScaleFree(n, rng);
+            else
+            {
+                cerr << "Unknown generator: " << generator << endl;
+                return 1;
+            }
+
+            for (BenchResult &r : benchmarkGraph(options, g))
+            {
+                mismatches += r.mismatches;
+                printf("%-10s %8d %9zu %-21s ", r.generator.c_str(), r.nodes, r.edges, r.algorithm.c_str());
+                if (r.status != "ok")
+                printf("%s\n", r.status.c_str());
+                else
+                {
+                    printf("%9d %12.1f %10.1f %10.1f %11.1f %10.1f", r.queries, r.qps, r.p50Us, r.p99Us,
+                           r.settled, r.memoryBytes / 1048576.0);
+                    auto it = baseline.find(resultKey(r.generator, r.nodes, r.algorithm));
+                    if (it != baseline.end() && it->second > 0)
+                    {
+                        double ratio = r.qps / it->second;
+                        printf("  %.2fx%s", ratio, ratio < 0.9 ? " REGRESSION" : "");
+                        regressions += ratio < 0.9;
+                    }
+                    if (r.mismatches)
+                    printf("  %d MISMATCHES", r.mismatches);
+                    printf("\n");
+                }
+                fflush(stdout);
+                all.push_back(r);
+            }
+        }
+    }
+
+    if (!writeResults(options.output, all, options))
+    {
+        cerr << "Cannot write " << options.output << endl;
+        return 1;
+    }
+    cout << "Results written to " << options.output << endl;
+    if (mismatches)
+    cerr << mismatches << " queries disagreed between algorithms" << endl;
+    if (regressions)
+    cerr << regressions << " results regressed by more than 10% against " << options.baseline << endl;
+    return mismatches ? 2 : regressions ? 3 : 0;
+}
@@ -0,0 +1,178 @@
+#include "route_cache.h"
+#include <algorithm>
+using namespace std;
+
+static bool isWeatherSensitive(const RoutePlan &plan)
+{
+    return plan.finalPath.empty() || plan.rerouted || !plan.badWeatherSegments.empty();
+}
+
+RouteCache::RouteCache(size_t capacity, size_t shardCount)
+    : shards(shardCount), shardCapacity(max<size_t>(1, capacity / shardCount))
+{
+}
+
+bool RouteCache::lookup(int src, int dst, uint64_t epoch, RoutePlan &out)
+{
+    uint64_t key = routeKey(src, dst);
+    Shard &shard = shardFor(key);
+    {
+        lock_guard<mutex> lock(shard.m);
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end() && it->second->epoch <= epoch)
+        {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            out = it->second->plan;
+            hitCount.fetch_add(1, memory_order_relaxed);
+            return true;
+        }
+    }
+    missCount.fetch_add(1, memory_order_relaxed);
+    return false;
+}
+
+void RouteCache::insert(int src, int dst, uint64_t epoch, const RoutePlan &plan)
+{
+    uint64_t key = routeKey(src, dst);
+    Shard &shard = shardFor(key);
+    lock_guard<mutex> lock(shard.m);
+    if (epoch < shard.invalidatedEpoch)
+    return;
+
+    auto existing = shard.entries.find(key);
+    if (existing != shard.entries.end())
+    {
+        if (existing->second->epoch >= epoch)
+        return;
+        erase(shard, existing->second);
+    }
+
+    Entry entry{key, epoch, plan, {}, isWeatherSensitive(plan)};
+    for (const auto *path : {&plan.directPath, &plan.finalPath})
+    for (size_t i = 1; i < path->size(); ++i)
+    entry.edges.push_back(edgeKey((*path)[i - 1], (*path)[i]));
+    sort(entry.edges.begin(), entry.edges.end());
+    entry.edges.erase(unique(entry.edges.begin(), entry.edges.end()), entry.edges.end());
+
+    shard.lru.push_front(move(entry));
+    auto it = shard.lru.begin();
+    shard.entries[key] = it;
+    for (uint64_t edge : it->edges)
+    shard.edgeIndex[edge].insert(key);
+    if (it->weatherSensitive)
+    shard.sensitive.insert(key);
+
+    while (shard.lru.size() > shardCapacity)
+    erase(shard, prev(shard.lru.end()));
+}
+
+void RouteCache::invalidate(const vector<WeatherUpdate> &batch, uint64_t epoch)
+{
+    bool anyCleared = false;
+    for (const auto &update : batch)
+    anyCleared |= !update.isBad;
+
+    for (Shard &shard : shards)
+    {
+        lock_guard<mutex> lock(shard.m);
+        shard.invalidatedEpoch = max(shard.invalidatedEpoch, epoch);
+
+        vector<uint64_t> victims;
+        for (const auto &update : batch)
+        {
+            auto it = shard.edgeIndex.find(edgeKey(update.u, update.v));
+            if (it != shard.edgeIndex.end())
+            victims.insert(victims.end(), it->second.begin(), it->second.end());
+        }
+        if (anyCleared)
+        victims.insert(victims.end(), shard.sensitive.begin(), shard.sensitive.end());
+
+        for (uint64_t key : victims)
+        {
+            auto it = shard.entries.find(key);
+            if (it != shard.entries.end())
+            {
+                erase(shard, it->second);
+                invalidatedCount.fetch_add(1, memory_order_relaxed);
+            }
+        }
+    }
+}
+
+void RouteCache::clear()
+{
+    for (Shard &shard : shards)
+    {
+        lock_guard<mutex> lock(shard.m);
+        shard.lru.clear();
+        shard.entries.clear();
+        shard.edgeIndex.clear();
+        shard.sensitive.clear();
+    }
+}
+
+RouteCache::Stats RouteCache::stats()
+{
+    size_t entries = 0;
+    for (Shard &shard : shards)
+    {
+        lock_guard<mutex> lock(shard.m);
+        entries += shard.lru.size();
+    }
+    return {hitCount.load(), missCount.load(), invalidatedCount.load(), entries};
+}
+
+void RouteCache::erase(Shard &shard, list<Entry>::iterator it)
+{
+    for (uint64_t edge : it->edges)
+    {
+        auto indexed = shard.edgeIndex.find(edge);
+        indexed->second.erase(it->key);
+        if (indexed->second.empty())
+        shard.edgeIndex.erase(indexed);
+    }
+    shard.sensitive.erase(it->key);
+    shard.entries.erase(it->key);
+    shard.lru.erase(it);
+}
+
+namespace
+{
+template <typename Planner>
+RoutePlan lookupOrPlan(WeatherEpochStore &store, RouteCache &cache, int src, int dst, Planner &&plan)
+{
+    auto snapshot = store.pin();
+    RoutePlan result;
+    if (cache.lookup(src, dst, snapshot->epoch, result))
+    return result;
+    result = plan(*snapshot);
+    cache.insert(src, dst, snapshot->epoch, result);
+    return result;
+}
+}
+
+RoutePlan cachedPlanRoute(const FlightGraph &graph, WeatherEpochStore &store, RouteCache &cache,
+                          int src, int dst, SearchWorkspace &ws)
+{
+    return lookupOrPlan(store, cache, src, dst, [&](const WeatherSnapshot &snapshot)
+    { return planRoute(graph, snapshot, src, dst, ws); });
+}
+
+RoutePlan cachedPlanRoute(const FlightGraph &graph, WeatherEpochStore &store, RouteCache &cache,
+                          int src, int dst, RouteTuner &tuner)
+{
+    return lookupOrPlan(store, cache, src, dst, [&](const WeatherSnapshot &snapshot)
+    { return planRoute(graph, snapshot, src, dst, tuner); });
+}
+
+RoutePlan cachedPlanRoute(const FlightGraph &graph, WeatherEpochStore &store, RouteCache &cache, int src, int dst)
+{
+    SearchWorkspace workspace;
+    return cachedPlanRoute(graph, store, cache, src, dst, workspace);
+}
+
+uint64_t publishWeather(WeatherEpochStore &store, RouteCache &cache, const vector<WeatherUpdate> &batch)
+{
+    TRACE_SCOPE("publishWeather");
+    return store.publish(batch, [&](uint64_t epoch) { cache.invalidate(batch, epoch); });
+}
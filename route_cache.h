@@ -0,0 +1,113 @@
+#ifndef ROUTE_CACHE_H
+#define ROUTE_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "flight_graph.h"
+#include "route_tuner.h"
+#include "weather_epochs.h"
+
+// Concurrent LRU cache of RoutePlans keyed by (src, dst), each entry tagged
+// with the weather epoch it was computed in. Entries are spread over
+// independently locked shards. A reverse index from edge to the cached
+// routes that use it (on either the direct or the final path) lets a
+// weather change drop only the affected routes:
+//  - an edge turning bad can only hurt routes that use it;
+//  - an edge clearing can additionally improve any route that is currently
+//    detoured or blocked by weather, so those "weather-sensitive" entries
+//    are dropped too. Routes already on their weather-free shortest path
+//    cannot improve and survive.
+// invalidate() must run before the new epoch becomes visible (see
+// WeatherEpochStore::publish), so that an insert computed from an older
+// epoch after the invalidation is rejected.
+class RouteCache
+{
+public:
+    struct Stats
+    {
+        std::uint64_t hits;
+        std::uint64_t misses;
+        std::uint64_t invalidated;
+        std::size_t entries;
+
+        double hitRate() const
+        {
+            std::uint64_t total = hits + misses;
+            return total ? double(hits) / total : 0.0;
+        }
+    };
+
+    explicit RouteCache(std::size_t capacity = 4096, std::size_t shardCount = 16);
+
+    bool lookup(int src, int dst, std::uint64_t epoch, RoutePlan &out);
+    void insert(int src, int dst, std::uint64_t epoch, const RoutePlan &plan);
+
+    // Drops every cached route the batch can affect; `epoch` is the epoch in
+    // which the batch becomes visible.
+    void invalidate(const std::vector<WeatherUpdate> &batch, std::uint64_t epoch);
+
+    void clear();
+    Stats stats();
+
+private:
+    struct Entry
+    {
+        std::uint64_t key;
+        std::uint64_t epoch;
+        RoutePlan plan;
+        std::vector<std::uint64_t> edges;
+        bool weatherSensitive;
+    };
+
+    struct Shard
+    {
+        std::mutex m;
+        std::list<Entry> lru;
+        std::unordered_map<std::uint64_t, std::list<Entry>::iterator> entries;
+        std::unordered_map<std::uint64_t, std::unordered_set<std::uint64_t>> edgeIndex;
+        std::unordered_set<std::uint64_t> sensitive;
+        std::uint64_t invalidatedEpoch = 0;
+    };
+
+    static std::uint64_t routeKey(int src, int dst)
+    {
+        return (std::uint64_t(std::uint32_t(src)) << 32) | std::uint32_t(dst);
+    }
+
+    static std::uint64_t edgeKey(int u, int v)
+    {
+        return u < v ? routeKey(u, v) : routeKey(v, u);
+    }
+
+    Shard &shardFor(std::uint64_t key)
+    {
+        return shards[(key * 0x9E3779B97F4A7C15ull >> 32) % shards.size()];
+    }
+
+    void erase(Shard &shard, std::list<Entry>::iterator it);
+
+    std::vector<Shard> shards;
+    std::size_t shardCapacity;
+    std::atomic<std::uint64_t> hitCount{0};
+    std::atomic<std::uint64_t> missCount{0};
+    std::atomic<std::uint64_t> invalidatedCount{0};
+};
+
+// Routes src -> dst against the store's current epoch, answering from the
+// cache when the route is still valid. Misses are searched with plain
+// Dijkstra, or with whatever strategy `tuner` picks.
+RoutePlan cachedPlanRoute(const FlightGraph &graph, WeatherEpochStore &store, RouteCache &cache,
+                          int src, int dst, SearchWorkspace &ws);
+RoutePlan cachedPlanRoute(const FlightGraph &graph, WeatherEpochStore &store, RouteCache &cache,
+                          int src, int dst, RouteTuner &tuner);
+RoutePlan cachedPlanRoute(const FlightGraph &graph, WeatherEpochStore &store, RouteCache &cache, int src, int dst);
+
+// Publishes a weather batch and invalidates the cached routes it affects.
+std::uint64_t publishWeather(WeatherEpochStore &store, RouteCache &cache, const std::vector<WeatherUpdate> &batch);
+
+#endif
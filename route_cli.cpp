@@ -0,0 +1,438 @@
+// route_cli.cpp
+// Headless batch front end for the routing library. Reads commands from a
+// file or stdin, one per line, and writes one result line per route query:
+//
+//    route <src> <dst>                      src/dst: index or IATA code
+//    weather <u> <v> bad|clear [description]
+//    cell <x> <y> bad|clear [description]   radar tile containing map point
+//    critical [count] [samples]             segments ranked by edge betweenness
+//    detours <src> <dst>                    best detour around each route segment
+//    route-at <time> <src> <dst>            route under the weather in effect at <time>
+//    clock <time>                           stamp later weather with <time>, not the wall clock
+//    stats
+//
+// Consecutive weather/cell lines are applied as one batch, so a burst of
+// updates costs a single epoch publish. Output format:
+//
+//    <SRC> <DST> ok <distance> rerouted=<0|1> <CODE> <CODE> ...
+//    <SRC> <DST> none
+//    # critical <rank> <U> <V> <score>
+//    # detour <U> <V> <distance>|none <CODE> <CODE> ...
+//
+// "critical" ranks segments by how many shortest routes between airport
+// pairs use them under the current weather (see betweenness.h), i.e. which
+// closures would reroute the most traffic. With samples > 0 it estimates
+// from that many random sources instead of all of them.
+//
+// "detours" prints the route line for src -> dst (always rerouted=0, as
+// there is no direct route to compare with) followed by one line per
+// segment of it: the shortest route if that segment alone closed (see
+// replacement_paths.h). It bypasses the cache.
+//
+// Every weather batch is recorded in a WeatherHistory, stamped with the
+// wall clock or the last "clock" time (milliseconds since the Unix epoch,
+// never going backwards). "route-at" answers against the weather in effect
+// at that time and prints a route line. --history keeps the history in a
+// file: it is loaded at start, the graph resumes the latest weather in it,
+// and it is written back at exit. Which grid cells were bad is not kept.
+//
+// Usage: route_cli [--input FILE] [--output FILE] [--no-cache] [--cell-size N]
+//                  [--metrics FILE] [--metrics-seconds N] [--trace FILE] [--autotune]
+//                  [--history FILE]
+//
+// --metrics writes search counters and latency percentiles (JSON, or
+// Prometheus text for *.prom/*.txt) periodically and at exit; it needs a
+// build with -DROUTING_STATS=1. --trace writes a Chrome trace_event file of
+// the run. --autotune routes each search with the fastest strategy for the
+// graph (see RouteTuner) and reports the choices at exit.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "betweenness.h"
+#include "cli_args.h"
+#include "flight_graph.h"
+#include "replacement_paths.h"
+#include "route_cache.h"
+#include "route_tuner.h"
+#include "routing_stats.h"
+#include "trace.h"
+#include "weather_epochs.h"
+#include "weather_grid.h"
+#include "weather_history.h"
+using namespace std;
+
+struct CliOptions
+{
+    string input;
+    string output;
+    bool useCache = true;
+    float cellSize = 50;
+    string metrics;
+    int metricsSeconds = 10;
+    string trace;
+    bool autotune = false;
+    string history;
+};
+
+void printUsage()
+{
+    cerr << "Usage: route_cli [--input FILE] [--output FILE] [--no-cache] [--cell-size N]"
+            " [--metrics FILE] [--metrics-seconds N] [--trace FILE] [--autotune] [--history FILE]" << endl;
+}
+
+bool parseOptions(int argc, char *argv[], CliOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--input" && i + 1 < argc)
+        options.input = argv[++i];
+        else if (arg == "--output" && i + 1 < argc)
+        options.output = argv[++i];
+        else if (arg == "--no-cache")
+        options.useCache = false;
+        else if (arg == "--cell-size" && i + 1 < argc)
+        options.cellSize = parseArg<float>(arg, argv[++i]);
+        else if (arg == "--metrics" && i + 1 < argc)
+        options.metrics = argv[++i];
+        else if (arg == "--metrics-seconds" && i + 1 < argc)
+        options.metricsSeconds = parseArg<int>(arg, argv[++i]);
+        else if (arg == "--trace" && i + 1 < argc)
+        options.trace = argv[++i];
+        else if (arg == "--autotune")
+        options.autotune = true;
+        else if (arg == "--history" && i + 1 < argc)
+        options.history = argv[++i];
+        else
+        {
+            cerr << "Unknown argument: " << arg << endl;
+            printUsage();
+            return false;
+        }
+    }
+    // Also rejects NaN.
+    if (!(options.cellSize > 0))
+    {
+        cerr << "--cell-size must be positive" << endl;
+        printUsage();
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    ios_base::sync_with_stdio(false);
+
+    CliOptions options;
+    try
+    {
+        if (!parseOptions(argc, argv, options))
+        return 1;
+    }
+    catch (const invalid_argument &e)
+    {
+        cerr << e.what() << endl;
+        printUsage();
+        return 1;
+    }
+
+    ifstream inputFile;
+    if (!options.input.empty())
+    {
+        inputFile.open(options.input);
+        if (!inputFile)
+        {
+            cerr << "Cannot open input file: " << options.input << endl;
+            return 1;
+        }
+    }
+    istream &in = options.input.empty() ? cin : inputFile;
+
+    FILE *out = stdout;
+    if (!options.output.empty())
+    {
+        out = fopen(options.output.c_str(), "w");
+        if (!out)
+        {
+            cerr << "Cannot open output file: " << options.output << endl;
+            return 1;
+        }
+    }
+
+    TraceSession traceSession(options.trace);
+    FlightGraph graph;
+    buildDefaultNetwork(graph);
+    WeatherGrid grid;
+    if (!grid.build(graph, options.cellSize))
+    {
+        cerr << "--cell-size " << options.cellSize << " is too small: the map would need more than "
+             << WeatherGrid::kMaxCells << " cells" << endl;
+        return 1;
+    }
+    // The network's initial weather is taken to hold since time 0.
+    WeatherHistory history(graph, 0);
+    if (!options.history.empty() && ifstream(options.history))
+    {
+        if (!history.load(options.history))
+        {
+            cerr << "Cannot read weather history: " << options.history << endl;
+            return 1;
+        }
+        history.restore(graph, history.endTime());
+    }
+    WeatherEpochStore store(graph);
+    RouteCache cache;
+
+    unique_ptr<MetricsExporter> exporter;
+    if (!options.metrics.empty())
+    {
+        if (!ROUTING_STATS)
+        cerr << "Warning: built without ROUTING_STATS; --metrics will only report zeros" << endl;
+        exporter = make_unique<MetricsExporter>(options.metrics, options.metricsSeconds);
+    }
+
+    SearchWorkspace workspace;
+    unique_ptr<RouteTuner> tuner;
+    if (options.autotune)
+    {
+        tuner = make_unique<RouteTuner>(graph);
+        const GraphProfile &profile = tuner->profile();
+        cerr << "Graph profile: " << profile.nodes << " airports, density " << profile.density << ", hop diameter "
+             << profile.hopDiameter << ", heuristic tightness " << profile.heuristicTightness << endl;
+    }
+    vector<WeatherUpdate> pending;
+    // Set by "clock"; -1 stamps weather with the wall clock.
+    int64_t clock = -1;
+    size_t routes = 0, updates = 0, batches = 0, errors = 0, lineNumber = 0;
+    string output;
+    output.reserve(1 << 16);
+
+    auto flushWeather = [&]()
+    {
+        if (pending.empty())
+        return;
+        publishWeather(store, cache, pending);
+        int64_t now = max(clock < 0 ? unixMillis() : clock, history.endTime());
+        for (const WeatherUpdate &update : pending)
+        history.record(now, update.u, update.v, update.isBad, update.description);
+        updates += pending.size();
+        ++batches;
+        pending.clear();
+    };
+
+    auto flushOutput = [&]()
+    {
+        fwrite(output.data(), 1, output.size(), out);
+        output.clear();
+    };
+
+    auto start = chrono::steady_clock::now();
+    string line, command;
+    while (getline(in, line))
+    {
+        ++lineNumber;
+        istringstream ss(line);
+        if (!(ss >> command) || command[0] == '#')
+        continue;
+
+        if (command == "route")
+        {
+            string a, b;
+            ss >> a >> b;
+            int src = resolveAirportIndex(a, graph);
+            int dst = resolveAirportIndex(b, graph);
+            if (src < 0 || dst < 0)
+            {
+                cerr << "line " << lineNumber << ": unknown airport" << endl;
+                ++errors;
+                continue;
+            }
+
+            flushWeather();
+            RoutePlan plan;
+            if (options.useCache && tuner)
+            plan = cachedPlanRoute(graph, store, cache, src, dst, *tuner);
+            else if (options.useCache)
+            plan = cachedPlanRoute(graph, store, cache, src, dst, workspace);
+            else if (tuner)
+            plan = planRoute(graph, *store.pin(), src, dst, *tuner);
+            else
+            plan = planRoute(graph, *store.pin(), src, dst, workspace);
+            appendRouteLine(output, graph, src, dst, plan);
+            ++routes;
+            if (output.size() > (1 << 16))
+            flushOutput();
+        }
+        else if (command == "weather" || command == "cell")
+        {
+            string a, b, condition, description;
+            ss >> a >> b >> condition;
+            getline(ss >> ws, description);
+            bool isBad = condition == "bad" || condition == "1";
+            if (description.empty())
+            description = isBad ? "Bad weather" : "Clear skies";
+
+            if (command == "weather")
+            {
+                int u = resolveAirportIndex(a, graph);
+                int v = resolveAirportIndex(b, graph);
+                if (u < 0 || v < 0 || u == v)
+                {
+                    cerr << "line " << lineNumber << ": invalid airport pair" << endl;
+                    ++errors;
+                    continue;
+                }
+                pending.push_back({u, v, isBad, description});
+            }
+            else
+            {
+                int cell = grid.cellAt(strtof(a.c_str(), nullptr), strtof(b.c_str(), nullptr));
+                if (cell < 0)
+                {
+                    cerr << "line " << lineNumber << ": point outside weather grid" << endl;
+                    ++errors;
+                    continue;
+                }
+                grid.setCell(cell, isBad, description, pending);
+            }
+        }
+        else if (command == "critical")
+        {
+            int count = 10;
+            BetweennessOptions betweenness;
+            ss >> count >> betweenness.samples;
+            flushWeather();
+            auto snapshot = store.pin();
+            vector<EdgeBetweenness> ranked = edgeBetweenness(
+                graph, [&](int u, int v) { return snapshot->available(u, v) && !snapshot->isBad(u, v); }, betweenness);
+            char buffer[160];
+            for (int i = 0; i < count && i < static_cast<int>(ranked.size()); ++i)
+            {
+                snprintf(buffer, sizeof(buffer), "# critical %d %s %s %.1f\n", i + 1,
+                         string(graph.airportCode(ranked[i].u)).c_str(), string(graph.airportCode(ranked[i].v)).c_str(),
+                         ranked[i].score);
+                output += buffer;
+            }
+        }
+        else if (command == "detours")
+        {
+            string a, b;
+            ss >> a >> b;
+            int src = resolveAirportIndex(a, graph);
+            int dst = resolveAirportIndex(b, graph);
+            if (src < 0 || dst < 0)
+            {
+                cerr << "line " << lineNumber << ": unknown airport" << endl;
+                ++errors;
+                continue;
+            }
+
+            flushWeather();
+            auto snapshot = store.pin();
+            ReplacementPaths detours = replacementPaths(
+                graph, src, dst, [&](int u, int v) { return snapshot->available(u, v) && !snapshot->isBad(u, v); });
+            RoutePlan plan;
+            plan.finalPath = detours.route;
+            plan.distance = detours.distance;
+            appendRouteLine(output, graph, src, dst, plan);
+            for (const Detour &detour : detours.detours)
+            {
+                output += "# detour ";
+                output += graph.airportCode(detour.u);
+                output += ' ';
+                output += graph.airportCode(detour.v);
+                if (detour.path.empty())
+                output += " none";
+                else
+                {
+                    char buffer[32];
+                    snprintf(buffer, sizeof(buffer), " %.2f", detour.distance);
+                    output += buffer;
+                }
+                for (int v : detour.path)
+                {
+                    output += ' ';
+                    output += graph.airportCode(v);
+                }
+                output += '\n';
+            }
+        }
+        else if (command == "route-at")
+        {
+            int64_t time;
+            string a, b;
+            ss >> time >> a >> b;
+            int src = resolveAirportIndex(a, graph);
+            int dst = resolveAirportIndex(b, graph);
+            if (!ss || src < 0 || dst < 0)
+            {
+                cerr << "line " << lineNumber << ": usage: route-at <time> <src> <dst>" << endl;
+                ++errors;
+                continue;
+            }
+
+            flushWeather();
+            appendRouteLine(output, graph, src, dst, planRoute(graph, history.stateAt(time), src, dst, workspace));
+            ++routes;
+        }
+        else if (command == "clock")
+        {
+            // Weather read so far keeps the time it was read at.
+            flushWeather();
+            int64_t time;
+            if (!(ss >> time) || time < history.endTime())
+            {
+                cerr << "line " << lineNumber << ": clock must be a time no earlier than the last recorded weather"
+                     << endl;
+                ++errors;
+                continue;
+            }
+            clock = time;
+        }
+        else if (command == "stats")
+        {
+            flushWeather();
+            auto stats = cache.stats();
+            char buffer[160];
+            snprintf(buffer, sizeof(buffer), "# stats routes=%zu updates=%zu cache_hits=%llu cache_misses=%llu hit_rate=%.3f\n",
+                     routes, updates, (unsigned long long)stats.hits, (unsigned long long)stats.misses, stats.hitRate());
+            output += buffer;
+        }
+        else
+        {
+            cerr << "line " << lineNumber << ": unknown command '" << command << "'" << endl;
+            ++errors;
+        }
+    }
+    flushWeather();
+    flushOutput();
+    if (out != stdout)
+    fclose(out);
+    if (!options.history.empty() && !history.save(options.history))
+    {
+        cerr << "Cannot write weather history: " << options.history << endl;
+        return 1;
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    auto stats = cache.stats();
+    cerr << "Processed " << routes << " routes and " << updates << " weather updates ("
+         << batches << " batches) in " << seconds << " s";
+    if (seconds > 0)
+    cerr << " - " << static_cast<long long>(routes / seconds) << " routes/s";
+    cerr << "\nCache: " << stats.hits << " hits, " << stats.misses << " misses, hit rate "
+         << stats.hitRate() << "\n";
+    if (tuner)
+    cerr << tuner->summary();
+    return errors ? 2 : 0;
+}
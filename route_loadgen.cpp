@@ -0,0 +1,197 @@
+// route_loadgen.cpp
+// Load generator for route_server. Opens several connections, keeps up to
+// `--pipeline` requests in flight on each and reports throughput and
+// latency percentiles measured at the client.
+//
+// Usage: route_loadgen [--host ADDR] [--port N] [--connections N]
+//                      [--requests N] [--pipeline N] [--weather-every N] [--seed N]
+//
+// --requests is per connection. With --weather-every N, every Nth request
+// is a weather toggle instead of a route query, which exercises cache
+// invalidation under load.
+
+#include <SFML/Network.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cli_args.h"
+using namespace std;
+
+using SteadyClock = chrono::steady_clock;
+
+static const char *airportCodes[] = {"JFK", "LAX", "ORD", "DFW", "ATL", "SFO", "MIA", "SEA",
+                                     "DEN", "BOS", "LAS", "PHX", "IAH", "EWR", "CLT"};
+static const int airportCount = sizeof(airportCodes) / sizeof(airportCodes[0]);
+
+struct LoadOptions
+{
+    string host = "127.0.0.1";
+    unsigned short port = 5400;
+    int connections = 4;
+    int requests = 100000;
+    int pipeline = 32;
+    int weatherEvery = 0;
+    unsigned seed = 1;
+};
+
+struct ConnectionResult
+{
+    vector<uint32_t> latencies;
+    int errors = 0;
+    bool failed = false;
+};
+
+// Drives one connection: sends while fewer than `pipeline` requests are
+// outstanding, and matches each response line to the oldest outstanding
+// request (the server answers in order).
+void runConnection(const LoadOptions &options, unsigned seed, ConnectionResult &result)
+{
+    sf::TcpSocket socket;
+    if (socket.connect(options.host, options.port, sf::seconds(5)) != sf::Socket::Done)
+    {
+        result.failed = true;
+        return;
+    }
+
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, airportCount - 1);
+    deque<SteadyClock::time_point> inFlight;
+    result.latencies.reserve(options.requests);
+
+    int sent = 0;
+    string request, pending;
+    char buffer[16384];
+    while (static_cast<int>(result.latencies.size()) < options.requests)
+    {
+        request.clear();
+        while (sent < options.requests && static_cast<int>(inFlight.size()) < options.pipeline)
+        {
+            int a = pick(rng), b = pick(rng);
+            while (b == a)
+            b = pick(rng);
+            ++sent;
+            if (options.weatherEvery > 0 && sent % options.weatherEvery == 0)
+            request += string("weather ") + airportCodes[a] + " " + airportCodes[b] + (rng() & 1 ? " bad Storm\n" : " clear\n");
+            else
+            request += string("route ") + airportCodes[a] + " " + airportCodes[b] + "\n";
+            inFlight.push_back(SteadyClock::now());
+        }
+        if (!request.empty() && socket.send(request.data(), request.size()) != sf::Socket::Done)
+        {
+            result.failed = true;
+            return;
+        }
+
+        size_t received = 0;
+        if (socket.receive(buffer, sizeof(buffer), received) != sf::Socket::Done)
+        {
+            result.failed = true;
+            return;
+        }
+        auto now = SteadyClock::now();
+        pending.append(buffer, received);
+        size_t start = 0, end;
+        while ((end = pending.find('\n', start)) != string::npos)
+        {
+            if (pending.compare(start, 5, "error") == 0)
+            ++result.errors;
+            start = end + 1;
+            auto micros = chrono::duration_cast<chrono::microseconds>(now - inFlight.front()).count();
+            inFlight.pop_front();
+            result.latencies.push_back(static_cast<uint32_t>(micros));
+        }
+        pending.erase(0, start);
+    }
+    socket.disconnect();
+}
+
+void printUsage()
+{
+    cerr << "Usage: route_loadgen [--host ADDR] [--port N] [--connections N] [--requests N]"
+            " [--pipeline N] [--weather-every N] [--seed N]" << endl;
+}
+
+bool parseOptions(int argc, char *argv[], LoadOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (i + 1 >= argc)
+        arg = "";
+        if (arg == "--host")
+        options.host = argv[++i];
+        else if (arg == "--port")
+        options.port = parseArg<unsigned short>(arg, argv[++i]);
+        else if (arg == "--connections")
+        options.connections = max(1, parseArg<int>(arg, argv[++i]));
+        else if (arg == "--requests")
+        options.requests = max(1, parseArg<int>(arg, argv[++i]));
+        else if (arg == "--pipeline")
+        options.pipeline = max(1, parseArg<int>(arg, argv[++i]));
+        else if (arg == "--weather-every")
+        options.weatherEvery = max(0, parseArg<int>(arg, argv[++i]));
+        else if (arg == "--seed")
+        options.seed = parseArg<unsigned>(arg, argv[++i]);
+        else
+        {
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    LoadOptions options;
+    try
+    {
+        if (!parseOptions(argc, argv, options))
+        return 1;
+    }
+    catch (const invalid_argument &e)
+    {
+        cerr << e.what() << endl;
+        printUsage();
+        return 1;
+    }
+
+    vector<ConnectionResult> results(options.connections);
+    vector<thread> threads;
+    auto start = SteadyClock::now();
+    for (int c = 0; c < options.connections; ++c)
+    threads.emplace_back(runConnection, cref(options), options.seed + c, ref(results[c]));
+    for (auto &t : threads)
+    t.join();
+    double seconds = chrono::duration<double>(SteadyClock::now() - start).count();
+
+    vector<uint32_t> all;
+    int errors = 0, failed = 0;
+    for (auto &r : results)
+    {
+        all.insert(all.end(), r.latencies.begin(), r.latencies.end());
+        errors += r.errors;
+        failed += r.failed;
+    }
+    if (failed)
+    cerr << failed << " connection(s) failed" << endl;
+    if (all.empty())
+    return 1;
+
+    sort(all.begin(), all.end());
+    auto at = [&](double q) { return all[min(all.size() - 1, static_cast<size_t>(q * all.size()))]; };
+    cout << all.size() << " responses in " << seconds << " s over " << options.connections
+         << " connections (pipeline " << options.pipeline << ")\n"
+         << "Throughput: " << static_cast<long long>(all.size() / seconds) << " req/s\n"
+         << "Latency us: p50 " << at(0.50) << ", p90 " << at(0.90) << ", p99 " << at(0.99)
+         << ", max " << all.back() << "\n"
+         << "Errors: " << errors << endl;
+    return failed || errors ? 2 : 0;
+}
@@ -0,0 +1,593 @@
+// route_server.cpp
+// Long-running route server. Keeps the FlightGraph, weather epochs and route
+// cache hot in memory and answers line-based requests over localhost TCP:
+//
+//    route <src> <dst>                        -> <SRC> <DST> ok <distance> rerouted=<0|1> <CODE>...
+//    weather <u> <v> bad|clear [description]  -> ok epoch=<n>
+//    route-at <time> <src> <dst>              -> route line under the weather at <time>
+//    stats                                    -> stats requests=<n> p50_us=<n> p99_us=<n> ...
+//    quit
+//
+// Clients may pipeline requests on one connection; a worker pool answers
+// them in parallel (each worker with its own SearchWorkspace) and responses
+// are written back in request order. Once 256 requests are waiting for
+// their responses to be written, the server stops reading that
+// connection until the client reads.
+//
+// A weather feed can also be sent as UDP datagrams to --weather-port, one or
+// more "weather ..." lines per datagram. Feed updates are not acknowledged;
+// they are coalesced per edge for --ingest-window-ms and published as one
+// batch (see WeatherIngestQueue).
+//
+// Every published batch is also recorded in a WeatherHistory stamped with
+// the wall clock, so "route-at" can answer for any time since the server
+// started (milliseconds since the Unix epoch). The history is kept in
+// memory only.
+//
+// Usage: route_server [--port N] [--workers N] [--report-seconds N]
+//                     [--weather-port N] [--ingest-window-ms N] [--metrics FILE]
+//                     [--autotune]
+//
+// --metrics periodically writes search counters and latency histograms per
+// query type (needs a build with -DROUTING_STATS=1); see routing_stats.h.
+// --autotune gives every worker a RouteTuner over a shared graph profile.
+
+#include <SFML/Network.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cli_args.h"
+#include "flight_graph.h"
+#include "route_cache.h"
+#include "route_tuner.h"
+#include "routing_stats.h"
+#include "weather_epochs.h"
+#include "weather_history.h"
+#include "weather_ingest.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#endif
+using namespace std;
+
+using SteadyClock = chrono::steady_clock;
+
+struct ServerOptions
+{
+    unsigned short port = 5400;
+    unsigned workers = max(2u, thread::hardware_concurrency());
+    int reportSeconds = 10;
+    unsigned short weatherPort = 5401;
+    int ingestWindowMs = 20;
+    string metrics;
+    bool autotune = false;
+};
+
+// A TCP socket that can be shut down from one thread while another is
+// blocked in receive(). Unlike disconnect(), shutdown keeps the descriptor
+// open, so it cannot be reused by a new connection while still in use; it
+// is closed when the socket is destroyed.
+class ClientSocket : public sf::TcpSocket
+{
+public:
+    void shutdown()
+    {
+#ifdef _WIN32
+        ::shutdown(getHandle(), SD_BOTH);
+#else
+        ::shutdown(getHandle(), SHUT_RDWR);
+#endif
+    }
+};
+
+// Shared by the connection's read and write loops and its queued jobs; the
+// socket is closed when the last of them lets go.
+struct Connection
+{
+    // Requests read but not yet written back. At this many the connection
+    // stops reading, so a client that pipelines without reading its
+    // responses holds at most this much memory and never blocks a worker.
+    static constexpr uint64_t kMaxInFlight = 256;
+
+    ClientSocket socket;
+    mutex m;
+    condition_variable changed;
+    uint64_t nextToSend = 0;
+    map<uint64_t, string> ready;
+    uint64_t closeAfter = UINT64_MAX;
+    bool open = true;
+
+    // Queues the response for request `seq` for writeLoop().
+    void complete(uint64_t seq, string response)
+    {
+        lock_guard<mutex> lock(m);
+        ready.emplace(seq, move(response));
+        changed.notify_all();
+    }
+
+    // Waits until request `seq` may be read; false once the connection is
+    // closed.
+    bool admit(uint64_t seq)
+    {
+        unique_lock<mutex> lock(m);
+        changed.wait(lock, [&] { return !open || seq - nextToSend < kMaxInFlight; });
+        return open;
+    }
+
+    void closeAfterRequest(uint64_t seq)
+    {
+        lock_guard<mutex> lock(m);
+        closeAfter = seq + 1;
+        changed.notify_all();
+    }
+
+    void close()
+    {
+        lock_guard<mutex> lock(m);
+        open = false;
+        changed.notify_all();
+    }
+
+    // Sends responses in request order as they become contiguous. Runs on
+    // its own thread, so a slow reader only ever blocks this one. The
+    // connection is closed once everything up to a `quit` has gone out.
+    void writeLoop()
+    {
+        unique_lock<mutex> lock(m);
+        for (;;)
+        {
+            changed.wait(lock, [&] { return !open || (!ready.empty() && ready.begin()->first == nextToSend); });
+            if (!open)
+            return;
+            string out;
+            uint64_t next = nextToSend;
+            for (auto it = ready.begin(); it != ready.end() && it->first == next; it = ready.erase(it))
+            {
+                out += it->second;
+                ++next;
+            }
+            lock.unlock();
+            bool sent = out.empty() || socket.send(out.data(), out.size()) == sf::Socket::Done;
+            lock.lock();
+            nextToSend = next;
+            if (!sent || nextToSend >= closeAfter)
+            {
+                // Ends a receive() blocked in readLoop() too.
+                open = false;
+                socket.shutdown();
+            }
+            changed.notify_all();
+        }
+    }
+};
+
+struct Job
+{
+    shared_ptr<Connection> connection;
+    uint64_t seq;
+    string line;
+    SteadyClock::time_point received;
+};
+
+class JobQueue
+{
+public:
+    void push(Job job)
+    {
+        {
+            lock_guard<mutex> lock(m);
+            jobs.push_back(move(job));
+        }
+        ready.notify_one();
+    }
+
+    Job pop()
+    {
+        unique_lock<mutex> lock(m);
+        ready.wait(lock, [this] { return !jobs.empty(); });
+        Job job = move(jobs.front());
+        jobs.pop_front();
+        return job;
+    }
+
+private:
+    mutex m;
+    condition_variable ready;
+    deque<Job> jobs;
+};
+
+// Request latencies (microseconds) for the current reporting window, one
+// uncontended buffer per worker.
+class LatencyWindow
+{
+public:
+    explicit LatencyWindow(unsigned workers) : buffers(workers) {}
+
+    void record(unsigned worker, uint32_t micros)
+    {
+        lock_guard<mutex> lock(buffers[worker].m);
+        buffers[worker].samples.push_back(micros);
+    }
+
+    // Percentiles over the window; `reset` starts a new window.
+    void percentiles(uint64_t &count, uint32_t &p50, uint32_t &p99, uint32_t &maximum, bool reset)
+    {
+        vector<uint32_t> all;
+        for (auto &buffer : buffers)
+        {
+            lock_guard<mutex> lock(buffer.m);
+            all.insert(all.end(), buffer.samples.begin(), buffer.samples.end());
+            if (reset)
+            buffer.samples.clear();
+        }
+        count = all.size();
+        p50 = p99 = maximum = 0;
+        if (all.empty())
+        return;
+        auto at = [&](double q)
+        {
+            size_t k = min(all.size() - 1, static_cast<size_t>(q * all.size()));
+            nth_element(all.begin(), all.begin() + k, all.end());
+            return all[k];
+        };
+        p50 = at(0.50);
+        p99 = at(0.99);
+        maximum = *max_element(all.begin(), all.end());
+    }
+
+private:
+    struct Buffer
+    {
+        mutex m;
+        vector<uint32_t> samples;
+    };
+    vector<Buffer> buffers;
+};
+
+class RouteServer
+{
+public:
+    // Only the workers pin weather snapshots, so the store gets one reader
+    // slot per worker.
+    RouteServer(const ServerOptions &options)
+        : options(options), store((buildDefaultNetwork(graph), graph), options.workers),
+          history(graph, unixMillis()), latencies(options.workers),
+          ingest([this](const vector<WeatherUpdate> &batch) { publish(batch); },
+                 chrono::milliseconds(options.ingestWindowMs))
+    {
+    }
+
+    int run()
+    {
+        sf::TcpListener listener;
+        if (listener.listen(options.port, sf::IpAddress::LocalHost) != sf::Socket::Done)
+        {
+            cerr << "Cannot listen on port " << options.port << endl;
+            return 1;
+        }
+        cout << "Route server listening on 127.0.0.1:" << options.port
+             << " with " << options.workers << " workers" << endl;
+
+        if (options.autotune)
+        {
+            profile = profileGraph(graph);
+            cout << "Autotuning searches: density " << profile.density << ", hop diameter " << profile.hopDiameter
+                 << ", heuristic tightness " << profile.heuristicTightness << endl;
+        }
+        for (unsigned i = 0; i < options.workers; ++i)
+        thread(&RouteServer::workerLoop, this, i).detach();
+        thread(&RouteServer::reportLoop, this).detach();
+        if (!options.metrics.empty())
+        {
+            if (!ROUTING_STATS)
+            cerr << "Warning: built without ROUTING_STATS; --metrics will only report zeros" << endl;
+            exporter = make_unique<MetricsExporter>(options.metrics, options.reportSeconds);
+        }
+        if (options.weatherPort)
+        {
+            if (feed.bind(options.weatherPort, sf::IpAddress::LocalHost) != sf::Socket::Done)
+            {
+                cerr << "Cannot bind weather feed port " << options.weatherPort << endl;
+                return 1;
+            }
+            cout << "Weather feed on udp 127.0.0.1:" << options.weatherPort << endl;
+            thread(&RouteServer::feedLoop, this).detach();
+        }
+
+        for (;;)
+        {
+            auto connection = make_shared<Connection>();
+            if (listener.accept(connection->socket) != sf::Socket::Done)
+            continue;
+            thread(&Connection::writeLoop, connection).detach();
+            thread(&RouteServer::readLoop, this, connection).detach();
+        }
+    }
+
+private:
+    void readLoop(shared_ptr<Connection> connection)
+    {
+        uint64_t seq = 0;
+        string pending;
+        char buffer[16384];
+        size_t received = 0;
+        while (connection->socket.receive(buffer, sizeof(buffer), received) == sf::Socket::Done)
+        {
+            auto now = SteadyClock::now();
+            pending.append(buffer, received);
+            size_t start = 0, end;
+            while ((end = pending.find('\n', start)) != string::npos)
+            {
+                string line = pending.substr(start, end - start);
+                if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+                start = end + 1;
+                if (line.empty())
+                continue;
+                if (!connection->admit(seq))
+                return;
+                if (line == "quit")
+                {
+                    connection->closeAfterRequest(seq);
+                    jobs.push({connection, seq++, move(line), now});
+                    return;
+                }
+                jobs.push({connection, seq++, move(line), now});
+            }
+            pending.erase(0, start);
+        }
+        connection->close();
+    }
+
+    void feedLoop()
+    {
+        vector<char> buffer(sf::UdpSocket::MaxDatagramSize);
+        size_t received = 0;
+        sf::IpAddress sender;
+        unsigned short port;
+        string line, command;
+        for (;;)
+        {
+            if (feed.receive(buffer.data(), buffer.size(), received, sender, port) != sf::Socket::Done)
+            continue;
+            istringstream datagram(string(buffer.data(), received));
+            while (getline(datagram, line))
+            {
+                istringstream ss(line);
+                WeatherUpdate update;
+                if (!(ss >> command))
+                continue;
+                // One bad line is rejected and counted; it must never stop
+                // the feed.
+                try
+                {
+                    if (command == "weather" && parseWeatherArgs(ss, graph, update))
+                    {
+                        ingest.push(move(update));
+                        continue;
+                    }
+                }
+                catch (const exception &)
+                {
+                }
+                feedErrors.fetch_add(1, memory_order_relaxed);
+            }
+        }
+    }
+
+    void workerLoop(unsigned worker)
+    {
+        SearchWorkspace workspace;
+        unique_ptr<RouteTuner> tuner;
+        if (options.autotune)
+        tuner = make_unique<RouteTuner>(graph, profile);
+        for (;;)
+        {
+            Job job = jobs.pop();
+            string response;
+            try
+            {
+                response = handle(job, workspace, tuner.get());
+            }
+            catch (const exception &e)
+            {
+                requestErrors.fetch_add(1, memory_order_relaxed);
+                response = string("error ") + e.what() + "\n";
+            }
+            auto micros = chrono::duration_cast<chrono::microseconds>(SteadyClock::now() - job.received).count();
+            latencies.record(worker, static_cast<uint32_t>(micros));
+            requests.fetch_add(1, memory_order_relaxed);
+            job.connection->complete(job.seq, move(response));
+        }
+    }
+
+    string handle(const Job &job, SearchWorkspace &workspace, RouteTuner *tuner)
+    {
+        istringstream ss(job.line);
+        string command;
+        ss >> command;
+
+        if (command == "route")
+        {
+            string a, b;
+            ss >> a >> b;
+            int src = resolveAirportIndex(a, graph);
+            int dst = resolveAirportIndex(b, graph);
+            if (src < 0 || dst < 0)
+            return "error unknown airport\n";
+            string out;
+            appendRouteLine(out, graph, src, dst,
+                            tuner ? cachedPlanRoute(graph, store, cache, src, dst, *tuner)
+                                  : cachedPlanRoute(graph, store, cache, src, dst, workspace));
+            return out;
+        }
+        if (command == "weather")
+        {
+            WeatherUpdate update;
+            if (!parseWeatherArgs(ss, graph, update))
+            return "error invalid airport pair\n";
+            uint64_t epoch = publish({update});
+            return "ok epoch=" + to_string(epoch) + "\n";
+        }
+        if (command == "route-at")
+        {
+            int64_t time;
+            string a, b;
+            ss >> time >> a >> b;
+            int src = resolveAirportIndex(a, graph);
+            int dst = resolveAirportIndex(b, graph);
+            if (!ss || src < 0 || dst < 0)
+            return "error usage: route-at <time> <src> <dst>\n";
+            // The plan reads descriptions from the history, so recording
+            // waits until it is done.
+            lock_guard<mutex> lock(historyMutex);
+            string out;
+            appendRouteLine(out, graph, src, dst, planRoute(graph, history.stateAt(time), src, dst, workspace));
+            return out;
+        }
+        if (command == "stats")
+        {
+            uint64_t count;
+            uint32_t p50, p99, maximum;
+            latencies.percentiles(count, p50, p99, maximum, false);
+            auto stats = cache.stats();
+            auto feedStats = ingest.stats();
+            char buffer[400];
+            snprintf(buffer, sizeof(buffer),
+                     "stats requests=%llu window=%llu p50_us=%u p99_us=%u max_us=%u cache_hit_rate=%.3f"
+                     " feed_received=%llu feed_coalesced=%llu feed_applied=%llu feed_batches=%llu"
+                     " feed_queue=%zu feed_applied_per_s=%.0f feed_errors=%llu request_errors=%llu\n",
+                     (unsigned long long)requests.load(), (unsigned long long)count, p50, p99, maximum, stats.hitRate(),
+                     (unsigned long long)feedStats.received, (unsigned long long)feedStats.coalesced,
+                     (unsigned long long)feedStats.applied, (unsigned long long)feedStats.batches,
+                     feedStats.queueDepth, feedStats.appliedPerSecond, (unsigned long long)feedErrors.load(),
+                     (unsigned long long)requestErrors.load());
+            return buffer;
+        }
+        if (command == "quit")
+        return "";
+        return "error unknown command\n";
+    }
+
+    // Publishes a batch and records it, under one lock so that the history
+    // holds batches in epoch order.
+    uint64_t publish(const vector<WeatherUpdate> &batch)
+    {
+        lock_guard<mutex> lock(historyMutex);
+        int64_t now = max(unixMillis(), history.endTime());
+        for (const WeatherUpdate &update : batch)
+        history.record(now, update.u, update.v, update.isBad, update.description);
+        return publishWeather(store, cache, batch);
+    }
+
+    void reportLoop()
+    {
+        uint64_t lastRequests = 0;
+        for (;;)
+        {
+            this_thread::sleep_for(chrono::seconds(options.reportSeconds));
+            uint64_t count;
+            uint32_t p50, p99, maximum;
+            latencies.percentiles(count, p50, p99, maximum, true);
+            uint64_t total = requests.load();
+            auto stats = cache.stats();
+            cout << "[" << options.reportSeconds << "s] " << (total - lastRequests) / options.reportSeconds
+                 << " req/s, p50 " << p50 << " us, p99 " << p99 << " us, max " << maximum
+                 << " us, cache hit rate " << stats.hitRate();
+            if (options.weatherPort)
+            {
+                auto feedStats = ingest.stats();
+                cout << ", feed " << static_cast<long long>(feedStats.appliedPerSecond) << " applied/s, queue "
+                     << feedStats.queueDepth << ", " << feedStats.coalesced << " coalesced";
+            }
+            cout << endl;
+            lastRequests = total;
+        }
+    }
+
+    ServerOptions options;
+    FlightGraph graph;
+    GraphProfile profile;
+    WeatherEpochStore store;
+    mutex historyMutex;
+    WeatherHistory history;
+    RouteCache cache;
+    JobQueue jobs;
+    LatencyWindow latencies;
+    atomic<uint64_t> requests{0};
+    WeatherIngestQueue ingest;
+    sf::UdpSocket feed;
+    atomic<uint64_t> feedErrors{0};
+    // Requests that threw while being handled; each got an error response.
+    atomic<uint64_t> requestErrors{0};
+    unique_ptr<MetricsExporter> exporter;
+};
+
+void printUsage()
+{
+    cerr << "Usage: route_server [--port N] [--workers N] [--report-seconds N]"
+            " [--weather-port N] [--ingest-window-ms N] [--metrics FILE] [--autotune]" << endl;
+}
+
+bool parseOptions(int argc, char *argv[], ServerOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--port" && i + 1 < argc)
+        options.port = parseArg<unsigned short>(arg, argv[++i]);
+        else if (arg == "--workers" && i + 1 < argc)
+        options.workers = max(1, parseArg<int>(arg, argv[++i]));
+        else if (arg == "--report-seconds" && i + 1 < argc)
+        options.reportSeconds = max(1, parseArg<int>(arg, argv[++i]));
+        else if (arg == "--weather-port" && i + 1 < argc)
+        options.weatherPort = parseArg<unsigned short>(arg, argv[++i]);
+        else if (arg == "--ingest-window-ms" && i + 1 < argc)
+        options.ingestWindowMs = max(0, parseArg<int>(arg, argv[++i]));
+        else if (arg == "--metrics" && i + 1 < argc)
+        options.metrics = argv[++i];
+        else if (arg == "--autotune")
+        options.autotune = true;
+        else
+        {
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    ServerOptions options;
+    try
+    {
+        if (!parseOptions(argc, argv, options))
+        return 1;
+    }
+    catch (const invalid_argument &e)
+    {
+        cerr << e.what() << endl;
+        printUsage();
+        return 1;
+    }
+
+    RouteServer server(options);
+    return server.run();
+}
@@ -0,0 +1,194 @@
+#include "route_tuner.h"
+#include <cstdio>
+#include <deque>
+#include <queue>
+#include <random>
+using namespace std;
+
+const char *routeStrategyName(RouteStrategy strategy)
+{
+    switch (strategy)
+    {
+    case RouteStrategy::Plain:
+        return "plain";
+    case RouteStrategy::Bidirectional:
+        return "bidirectional";
+    case RouteStrategy::AStar:
+        return "astar";
+    case RouteStrategy::DenseScan:
+        return "dense_scan";
+    default:
+        return "unknown";
+    }
+}
+
+namespace
+{
+double straightLine(const FlightGraph &graph, int u, int v)
+{
+    double dx = graph.airports[u].position.x - graph.airports[v].position.x;
+    double dy = graph.airports[u].position.y - graph.airports[v].position.y;
+    return sqrt(dx * dx + dy * dy);
+}
+
+// Hop distances from src; returns the farthest node reached.
+int farthestByHops(const FlightGraph &graph, int src, int &hops)
+{
+    vector<int> depth(graph.adj.size(), -1);
+    deque<int> frontier = {src};
+    depth[src] = 0;
+    int farthest = src;
+    while (!frontier.empty())
+    {
+        int u = frontier.front();
+        frontier.pop_front();
+        if (depth[u] > depth[farthest])
+        farthest = u;
+        for (auto [v, w] : graph.adj[u])
+        if (depth[v] < 0)
+        {
+            depth[v] = depth[u] + 1;
+            frontier.push_back(v);
+        }
+    }
+    hops = depth[farthest];
+    return farthest;
+}
+
+// Single-source distances ignoring weather.
+vector<double> distancesFrom(const FlightGraph &graph, int src)
+{
+    using PDI = pair<double, int>;
+    vector<double> dist(graph.adj.size(), numeric_limits<double>::infinity());
+    priority_queue<PDI, vector<PDI>, greater<PDI>> pq;
+    dist[src] = 0;
+    pq.push({0, src});
+    while (!pq.empty())
+    {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (d > dist[u])
+        continue;
+        for (auto [v, w] : graph.adj[u])
+        if (d + w < dist[v])
+        {
+            dist[v] = d + w;
+            pq.push({dist[v], v});
+        }
+    }
+    return dist;
+}
+}
+
+GraphProfile profileGraph(const FlightGraph &graph, int sampleSources, unsigned seed)
+{
+    TRACE_SCOPE("profileGraph");
+    GraphProfile profile;
+    int n = graph.adj.size();
+    profile.nodes = n;
+    if (n == 0)
+    return profile;
+
+    for (const auto &edges : graph.adj)
+    profile.arcs += edges.size();
+    profile.density = n > 1 ? double(profile.arcs) / (double(n) * (n - 1)) : 0;
+
+    int hops = 0;
+    int far = farthestByHops(graph, 0, hops);
+    farthestByHops(graph, far, hops);
+    profile.hopDiameter = hops;
+
+    Vec2 lo = graph.airports[0].position, hi = lo;
+    for (const auto &airport : graph.airports)
+    {
+        lo.x = min(lo.x, airport.position.x);
+        lo.y = min(lo.y, airport.position.y);
+        hi.x = max(hi.x, airport.position.x);
+        hi.y = max(hi.y, airport.position.y);
+    }
+    profile.span = hypot(double(hi.x - lo.x), double(hi.y - lo.y));
+
+    // Scaling straight-line distance by the smallest weight/length ratio of
+    // any edge keeps the heuristic consistent, hence A* exact. The small
+    // margin absorbs rounding in the comparison.
+    double scale = numeric_limits<double>::infinity();
+    for (int u = 0; u < n; ++u)
+    for (auto [v, w] : graph.adj[u])
+    {
+        double length = straightLine(graph, u, v);
+        if (length > 0)
+        scale = min(scale, w / length);
+    }
+    profile.heuristicScale = isfinite(scale) ? scale * (1 - 1e-9) : 0;
+
+    mt19937 rng(seed);
+    double ratioSum = 0;
+    size_t pairs = 0;
+    for (int i = 0; i < sampleSources && profile.heuristicScale > 0; ++i)
+    {
+        int src = rng() % n;
+        vector<double> dist = distancesFrom(graph, src);
+        for (int v = 0; v < n; ++v)
+        if (v != src && dist[v] > 0 && isfinite(dist[v]))
+        {
+            ratioSum += profile.heuristicScale * straightLine(graph, src, v) / dist[v];
+            ++pairs;
+        }
+    }
+    profile.heuristicTightness = pairs ? ratioSum / pairs : 0;
+    return profile;
+}
+
+RouteTuner::RouteTuner(const FlightGraph &graph) : RouteTuner(graph, profileGraph(graph))
+{
+}
+
+RouteTuner::RouteTuner(const FlightGraph &graph, const GraphProfile &profile)
+    : graph(graph), graphProfile(profile), tuner(static_cast<int>(RouteStrategy::Count), kQueryClasses)
+{
+    // Only strategies that can beat plain Dijkstra on this graph take part:
+    // a second frontier is pointless when every airport is a hop or two
+    // away, a loose heuristic guides A* no better than no heuristic, and the
+    // array scan only beats a heap when most airport pairs are connected.
+    tuner.setEnabled(static_cast<int>(RouteStrategy::Bidirectional), profile.hopDiameter > 2);
+    tuner.setEnabled(static_cast<int>(RouteStrategy::AStar), profile.heuristicTightness >= 0.25);
+    tuner.setEnabled(static_cast<int>(RouteStrategy::DenseScan), profile.density >= 0.25);
+}
+
+int RouteTuner::classify(int src, int dst) const
+{
+    if (graphProfile.span <= 0)
+    return 0;
+    double fraction = hypot(double(graph.airports[src].position.x - graph.airports[dst].position.x),
+                            double(graph.airports[src].position.y - graph.airports[dst].position.y)) /
+                      graphProfile.span;
+    return min(kQueryClasses - 1, static_cast<int>(fraction * kQueryClasses));
+}
+
+string RouteTuner::summary() const
+{
+    static const char *classNames[kQueryClasses] = {"short", "medium", "long"};
+    string out;
+    char buffer[128];
+    for (int c = 0; c < kQueryClasses; ++c)
+    {
+        long long total = 0;
+        for (int s = 0; s < tuner.strategyCount(); ++s)
+        total += tuner.timesChosen(c, s);
+        if (total == 0)
+        continue;
+
+        out += string("autotune ") + classNames[c] + ":";
+        int best = tuner.best(c);
+        for (int s = 0; s < tuner.strategyCount(); ++s)
+        {
+            if (!tuner.isEnabled(s))
+            continue;
+            snprintf(buffer, sizeof(buffer), " %s%s %.1fus %.0f%%", routeStrategyName(RouteStrategy(s)),
+                     s == best ? "*" : "", tuner.meanNanos(c, s) / 1000.0, 100.0 * tuner.timesChosen(c, s) / total);
+            out += buffer;
+        }
+        out += "\n";
+    }
+    return out;
+}
@@ -0,0 +1,312 @@
+#ifndef ROUTE_TUNER_H
+#define ROUTE_TUNER_H
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "flight_graph.h"
+#include "strategy_tuner.h"
+
+// Alternative point-to-point searches over a FlightGraph, all exact and all
+// taking the same availability predicate as FlightGraph::dijkstra, plus a
+// RouteTuner that sends each query to whichever of them is fastest on the
+// loaded graph.
+
+enum class RouteStrategy
+{
+    Plain,         // FlightGraph::dijkstra
+    Bidirectional, // Dijkstra from both ends, stopping when the frontiers meet
+    AStar,         // Dijkstra guided by scaled straight-line distance to dst
+    DenseScan,     // Dijkstra with an O(n) array scan instead of a heap
+    Count
+};
+
+const char *routeStrategyName(RouteStrategy strategy);
+
+// Facts about a graph that decide which strategies can pay off.
+struct GraphProfile
+{
+    int nodes = 0;
+    std::size_t arcs = 0;
+    // arcs / (nodes * (nodes - 1)); 1 for a complete graph.
+    double density = 0;
+    // Double-sweep BFS estimate (a lower bound) of the diameter in hops.
+    int hopDiameter = 0;
+    // Diagonal of the airports' bounding box, used to classify queries.
+    double span = 0;
+    // Largest factor such that scale * straight-line distance never exceeds
+    // an edge weight; the A* heuristic scaled by it is consistent.
+    double heuristicScale = 0;
+    // Mean of scaled straight-line distance / shortest-path distance over
+    // sampled pairs: 1 means A* only settles nodes on the shortest path.
+    double heuristicTightness = 0;
+};
+
+GraphProfile profileGraph(const FlightGraph &graph, int sampleSources = 4, unsigned seed = 1);
+
+// Scratch buffers for the strategies; `forward` is what the plain search and
+// the routing counters use.
+struct RouteWorkspace
+{
+    SearchWorkspace forward;
+    SearchWorkspace backward;
+    std::vector<char> done;
+
+    void prepare(int n)
+    {
+        forward.prepare(n);
+        backward.prepare(n);
+        if (static_cast<int>(done.size()) < n)
+        done.resize(n, 0);
+    }
+};
+
+// Appends `at` and then each prev link back to the root of its search.
+inline void appendPrevChain(std::vector<int> &path, const std::vector<int> &prev, int at)
+{
+    for (; at != -1; at = prev[at])
+    path.push_back(at);
+}
+
+template <typename Available>
+std::vector<int> bidirectionalDijkstra(const FlightGraph &graph, int src, int dst, const Available &available,
+                                       RouteWorkspace &rw)
+{
+    TRACE_SCOPE("bidirectionalDijkstra");
+    using PDI = std::pair<double, int>;
+    const double inf = std::numeric_limits<double>::infinity();
+    rw.prepare(graph.adj.size());
+    SearchWorkspace &fw = rw.forward;
+    SearchWorkspace &bw = rw.backward;
+    fw.settled = 0;
+    ROUTING_RESET_COUNTERS(fw);
+
+    fw.dist[src] = 0;
+    fw.touched.push_back(src);
+    fw.heap.assign(1, {0, src});
+    bw.dist[dst] = 0;
+    bw.touched.push_back(dst);
+    bw.heap.assign(1, {0, dst});
+
+    // Best complete route seen so far and the node where its halves meet.
+    double best = src == dst ? 0 : inf;
+    int meet = src == dst ? src : -1;
+
+    while (!fw.heap.empty() && !bw.heap.empty())
+    {
+        if (fw.heap.front().first + bw.heap.front().first >= best)
+        break;
+
+        // Expand whichever frontier is closer to its root.
+        bool forward = fw.heap.front().first <= bw.heap.front().first;
+        SearchWorkspace &ws = forward ? fw : bw;
+        SearchWorkspace &other = forward ? bw : fw;
+        int root = forward ? src : dst;
+
+        std::pop_heap(ws.heap.begin(), ws.heap.end(), std::greater<PDI>());
+        auto [d, u] = ws.heap.back();
+        ws.heap.pop_back();
+        if (d > ws.dist[u])
+        {
+            ROUTING_COUNT(fw, stalePops);
+            continue;
+        }
+        ++fw.settled;
+        ROUTING_COUNT(fw, settled);
+
+        for (auto [v, w] : graph.adj[u])
+        {
+            // Backward the search walks edges v -> u.
+            if (!(forward ? available(u, v) : available(v, u)))
+            {
+                ROUTING_COUNT(fw, edgesSkipped);
+                continue;
+            }
+            double alt = d + w;
+            if (alt < ws.dist[v])
+            {
+                if (ws.prev[v] == -1 && v != root)
+                ws.touched.push_back(v);
+                ws.dist[v] = alt;
+                ws.prev[v] = u;
+                ws.heap.push_back({alt, v});
+                std::push_heap(ws.heap.begin(), ws.heap.end(), std::greater<PDI>());
+                ROUTING_COUNT(fw, heapPushes);
+                if (alt + other.dist[v] < best)
+                {
+                    best = alt + other.dist[v];
+                    meet = v;
+                }
+            }
+        }
+    }
+
+    std::vector<int> path;
+    if (meet != -1)
+    {
+        appendPrevChain(path, fw.prev, meet);
+        std::reverse(path.begin(), path.end());
+        appendPrevChain(path, bw.prev, bw.prev[meet]);
+    }
+    fw.reset();
+    bw.reset();
+    return path;
+}
+
+template <typename Available>
+std::vector<int> astarSearch(const FlightGraph &graph, int src, int dst, const Available &available,
+                             double heuristicScale, RouteWorkspace &rw)
+{
+    TRACE_SCOPE("astarSearch");
+    SearchWorkspace &ws = rw.forward;
+    ws.settled = 0;
+    ROUTING_RESET_COUNTERS(ws);
+    const Vec2 goal = graph.airports[dst].position;
+    auto heuristic = [&](int v)
+    {
+        double dx = graph.airports[v].position.x - goal.x;
+        double dy = graph.airports[v].position.y - goal.y;
+        return heuristicScale * std::sqrt(dx * dx + dy * dy);
+    };
+    WorkspaceHooks<false> hooks{ws};
+    bestFirstSearch(graph.adj, src, dst, available, heuristic, ws, hooks);
+    std::vector<int> path = searchPath(ws, src, dst);
+    ws.reset();
+    return path;
+}
+
+// Settles the closest open node by scanning every node: O(n^2) overall but
+// with no heap traffic, which wins once most airport pairs are connected.
+template <typename Available>
+std::vector<int> denseScanDijkstra(const FlightGraph &graph, int src, int dst, const Available &available,
+                                   RouteWorkspace &rw)
+{
+    TRACE_SCOPE("denseScanDijkstra");
+    const double inf = std::numeric_limits<double>::infinity();
+    int n = graph.adj.size();
+    rw.prepare(n);
+    SearchWorkspace &ws = rw.forward;
+    std::vector<char> &done = rw.done;
+    ws.settled = 0;
+    ROUTING_RESET_COUNTERS(ws);
+    ws.dist[src] = 0;
+
+    for (;;)
+    {
+        int u = -1;
+        double d = inf;
+        for (int v = 0; v < n; ++v)
+        if (!done[v] && ws.dist[v] < d)
+        {
+            d = ws.dist[v];
+            u = v;
+        }
+        if (u == -1)
+            break;
+        ++ws.settled;
+        if (u == dst)
+            break;
+        done[u] = 1;
+        ROUTING_COUNT(ws, settled);
+
+        for (auto [v, w] : graph.adj[u])
+        {
+            if (!available(u, v))
+            {
+                ROUTING_COUNT(ws, edgesSkipped);
+                continue;
+            }
+            if (d + w < ws.dist[v])
+            {
+                ws.dist[v] = d + w;
+                ws.prev[v] = u;
+            }
+        }
+    }
+
+    std::vector<int> path;
+    if (dst == src || ws.prev[dst] != -1)
+    {
+        appendPrevChain(path, ws.prev, dst);
+        std::reverse(path.begin(), path.end());
+    }
+    // The scan already costs O(n), so a full reset adds nothing asymptotically.
+    std::fill(ws.dist.begin(), ws.dist.begin() + n, inf);
+    std::fill(ws.prev.begin(), ws.prev.begin() + n, -1);
+    std::fill(done.begin(), done.begin() + n, 0);
+    return path;
+}
+
+// Profiles the graph once, enables the strategies that can pay off on it and
+// then times every query to keep sending each class of query (short, medium
+// or long relative to the map) to the fastest one. Strategies only differ in
+// speed; ties between equally short routes may be broken differently.
+//
+// Keep one per thread. Tuners for the same graph can share one profile.
+class RouteTuner
+{
+public:
+    static const int kQueryClasses = 3;
+
+    explicit RouteTuner(const FlightGraph &graph);
+    RouteTuner(const FlightGraph &graph, const GraphProfile &profile);
+
+    template <typename Available>
+    std::vector<int> route(int src, int dst, const Available &available)
+    {
+        int queryClass = classify(src, dst);
+        auto strategy = static_cast<RouteStrategy>(tuner.choose(queryClass));
+        auto start = std::chrono::steady_clock::now();
+        std::vector<int> path;
+        switch (strategy)
+        {
+        case RouteStrategy::Bidirectional:
+            path = bidirectionalDijkstra(graph, src, dst, available, rw);
+            break;
+        case RouteStrategy::AStar:
+            path = astarSearch(graph, src, dst, available, graphProfile.heuristicScale, rw);
+            break;
+        case RouteStrategy::DenseScan:
+            path = denseScanDijkstra(graph, src, dst, available, rw);
+            break;
+        default:
+            path = graph.dijkstra(src, dst, available, rw.forward);
+            break;
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        tuner.record(queryClass, static_cast<int>(strategy), elapsed.count());
+        last = strategy;
+        return path;
+    }
+
+    const GraphProfile &profile() const { return graphProfile; }
+    RouteStrategy lastStrategy() const { return last; }
+    bool isEnabled(RouteStrategy strategy) const { return tuner.isEnabled(static_cast<int>(strategy)); }
+
+    // Workspace whose counters reflect the most recent search.
+    SearchWorkspace &workspace() { return rw.forward; }
+
+    // One line per query class: mean time and share of queries per strategy.
+    std::string summary() const;
+
+private:
+    int classify(int src, int dst) const;
+
+    const FlightGraph &graph;
+    GraphProfile graphProfile;
+    RouteWorkspace rw;
+    StrategyTuner tuner;
+    RouteStrategy last = RouteStrategy::Plain;
+};
+
+// planRoute() with both of its searches sent through the tuner.
+template <typename Weather>
+RoutePlan planRoute(const FlightGraph &graph, const Weather &weather, int src, int dst, RouteTuner &tuner)
+{
+    return planRouteWith(graph, weather, tuner.workspace(),
+                         [&](const auto &available) { return tuner.route(src, dst, available); });
+}
+
+#endif
@@ -0,0 +1,116 @@
+#include "route_worker.h"
+#include <chrono>
+using namespace std;
+
+RouteWorker::RouteWorker(const FlightGraph &graph)
+    : graph([&graph]
+      {
+          TRACE_SCOPE("copyGraph");
+          return graph;
+      }())
+{
+    thread = std::thread(&RouteWorker::run, this);
+}
+
+RouteWorker::~RouteWorker()
+{
+    stopping.store(true);
+    {
+        lock_guard<mutex> lock(m);
+        wake.notify_one();
+    }
+    thread.join();
+}
+
+bool RouteWorker::requestRoute(int src, int dst)
+{
+    return send({RouteCommand::Route, false, src, dst, 0});
+}
+
+bool RouteWorker::setWeather(int u, int v, bool isBad, StrId description)
+{
+    return send({RouteCommand::Weather, isBad, u, v, description});
+}
+
+bool RouteWorker::send(const RouteCommand &command)
+{
+    if (!commands.push(command))
+    return false;
+    ++sent;
+    // Pairs with the fence in run(): either the worker sees this command
+    // before it sleeps or we see it asleep and wake it. The lock is only
+    // taken then, and only held by the worker while it goes to sleep.
+    atomic_thread_fence(memory_order_seq_cst);
+    if (sleeping.load(memory_order_relaxed))
+    {
+        lock_guard<mutex> lock(m);
+        wake.notify_one();
+    }
+    return true;
+}
+
+const RouteResult *RouteWorker::takeResult()
+{
+    if (!(spare.load(memory_order_acquire) & kFresh))
+    return nullptr;
+    front = spare.exchange(front, memory_order_acq_rel) & ~kFresh;
+    taken = buffers[front].version;
+    return &buffers[front];
+}
+
+void RouteWorker::run()
+{
+    uint64_t applied = 0;
+    int src = -1, dst = -1;
+    for (;;)
+    {
+        bool changed = false;
+        bool newRoute = false;
+        RouteCommand command;
+        while (commands.pop(command))
+        {
+            changed = true;
+            ++applied;
+            if (command.type == RouteCommand::Route)
+            {
+                src = command.u;
+                dst = command.v;
+                newRoute = true;
+            }
+            else
+            graph.updateWeather(command.u, command.v, command.isBad, command.description);
+        }
+
+        if (changed)
+        {
+            TRACE_SCOPE("routeWorker");
+            RouteResult &result = buffers[back];
+            result.version = applied;
+            result.newRoute = newRoute;
+            result.src = src;
+            result.dst = dst;
+            result.trace.clear();
+            result.plan = RoutePlan();
+            auto start = chrono::steady_clock::now();
+            if (src >= 0 && dst >= 0)
+            {
+                workspace.trace = &result.trace;
+                result.plan = planRoute(graph, graph, src, dst, workspace);
+            }
+            result.searchMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            back = spare.exchange(back | kFresh, memory_order_acq_rel) & ~kFresh;
+            continue;
+        }
+
+        if (stopping.load())
+        return;
+        sleeping.store(true, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (commands.empty())
+        {
+            unique_lock<mutex> lock(m);
+            wake.wait(lock, [&] { return !commands.empty() || stopping.load(); });
+        }
+        sleeping.store(false, memory_order_relaxed);
+    }
+}
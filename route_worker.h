@@ -0,0 +1,112 @@
+#ifndef ROUTE_WORKER_H
+#define ROUTE_WORKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "flight_graph.h"
+#include "search_trace.h"
+#include "spsc_queue.h"
+
+// Edit sent from the render thread to the route worker. Kept small and
+// trivially copyable for the command queue; descriptions are interned by the
+// sender, so the worker never touches the shared string pool.
+struct RouteCommand
+{
+    enum Type : std::uint8_t
+    {
+        Route,
+        Weather
+    };
+
+    Type type;
+    bool isBad;
+    int u;
+    int v;
+    StrId description;
+};
+
+// A route planned by the worker, with the recorded weather-aware search.
+struct RouteResult
+{
+    // Number of commands applied before this plan; the render thread
+    // compares it with what it has sent to tell whether a reroute is pending.
+    std::uint64_t version = 0;
+    // True if a Route command was among them (as opposed to weather only).
+    bool newRoute = false;
+    int src = -1;
+    int dst = -1;
+    RoutePlan plan;
+    SearchTrace trace = SearchTrace(1 << 16);
+    double searchMs = 0;
+};
+
+// Plans routes on a background thread so a window never waits for a search.
+// The worker keeps its own copy of the graph. The render thread sends route
+// requests and weather edits through a lock-free single-producer queue, and
+// the worker applies every edit queued so far before planning once, so a
+// burst of clicks costs one search.
+//
+// Results are double buffered with a spare: the worker fills its back
+// buffer and swaps it with the spare, and the render thread swaps the spare
+// with its front buffer when a fresh one is waiting. Two buffers alone would
+// make one side wait for the other; with the spare neither ever does, and
+// the render thread always gets the newest plan.
+//
+// All methods but the constructor and destructor are for the render thread
+// only (the single producer and consumer).
+class RouteWorker
+{
+public:
+    static constexpr std::size_t kQueueCapacity = 1024;
+
+    // Copies `graph`, which must have interned every description later
+    // passed to setWeather().
+    explicit RouteWorker(const FlightGraph &graph);
+    ~RouteWorker();
+
+    RouteWorker(const RouteWorker &) = delete;
+    RouteWorker &operator=(const RouteWorker &) = delete;
+
+    // Both return false if the queue is full; they never block on a search.
+    bool requestRoute(int src, int dst);
+    bool setWeather(int u, int v, bool isBad, StrId description);
+
+    // Takes the newest result if one has been published since the last
+    // call; returns nullptr otherwise. The result stays valid until the next
+    // call that returns non-null.
+    const RouteResult *takeResult();
+
+    // True while commands are sent that no taken result reflects yet.
+    bool pending() const { return sent != taken; }
+
+private:
+    static constexpr int kFresh = 4;
+
+    bool send(const RouteCommand &command);
+    void run();
+
+    FlightGraph graph;
+    SearchWorkspace workspace;
+    SpscQueue<RouteCommand, kQueueCapacity> commands;
+
+    RouteResult buffers[3];
+    int back = 0;
+    int front = 1;
+    // Index of the spare buffer, plus kFresh if the worker has published it
+    // since the render thread last took it.
+    std::atomic<int> spare{2};
+
+    std::uint64_t sent = 0;
+    std::uint64_t taken = 0;
+
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> sleeping{false};
+    std::mutex m;
+    std::condition_variable wake;
+    std::thread thread;
+};
+
+#endif
@@ -0,0 +1,217 @@
+#include "routing_stats.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+using namespace std;
+
+const char *queryTypeName(QueryType type)
+{
+    switch (type)
+    {
+    case QueryType::Direct:
+        return "direct";
+    case QueryType::WeatherAware:
+        return "weather_aware";
+    case QueryType::Reroute:
+        return "reroute";
+    default:
+        return "unknown";
+    }
+}
+
+int LatencyHistogram::bucketOf(uint64_t value)
+{
+    if (value < kSubBuckets)
+    return static_cast<int>(value);
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - kSubBits;
+    return (shift + 1) * kSubBuckets + static_cast<int>((value >> shift) & (kSubBuckets - 1));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int bucket)
+{
+    if (bucket < kSubBuckets)
+    return bucket;
+    int shift = bucket / kSubBuckets - 1;
+    uint64_t top = kSubBuckets + bucket % kSubBuckets;
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+    buckets[bucketOf(value)].fetch_add(1, memory_order_relaxed);
+    total.fetch_add(1, memory_order_relaxed);
+    valueSum.fetch_add(value, memory_order_relaxed);
+    uint64_t seen = maximum.load(memory_order_relaxed);
+    while (value > seen && !maximum.compare_exchange_weak(seen, value, memory_order_relaxed))
+    {
+    }
+}
+
+uint64_t LatencyHistogram::percentile(double q) const
+{
+    // Concurrent records may land between the loads; the result is still a
+    // valid percentile of some recent state.
+    vector<uint64_t> counts(kBuckets);
+    uint64_t n = 0;
+    for (int i = 0; i < kBuckets; ++i)
+    n += counts[i] = buckets[i].load(memory_order_relaxed);
+    if (n == 0)
+    return 0;
+
+    // Nearest rank: the smallest sample with at least a fraction q of all
+    // samples at or below it. Written so a NaN q also lands on rank 1.
+    double exact = ceil(q * double(n));
+    uint64_t rank = !(exact >= 1) ? 1 : exact >= double(n) ? n : static_cast<uint64_t>(exact);
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+        return min(bucketUpperBound(i), max());
+    }
+    return max();
+}
+
+void RoutingMetrics::record(QueryType type, uint64_t nanos, const SearchCounters &counters)
+{
+    PerType &t = types[static_cast<int>(type)];
+    t.latency.record(nanos);
+    t.settled.fetch_add(counters.settled, memory_order_relaxed);
+    t.heapPushes.fetch_add(counters.heapPushes, memory_order_relaxed);
+    t.stalePops.fetch_add(counters.stalePops, memory_order_relaxed);
+    t.edgesSkipped.fetch_add(counters.edgesSkipped, memory_order_relaxed);
+}
+
+namespace
+{
+const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+const char *kQuantileNames[] = {"p50", "p90", "p99", "p999"};
+}
+
+string RoutingMetrics::toJson() const
+{
+    auto now = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    char buffer[512];
+    string out = "{\"timestamp_ms\":" + to_string(now) + ",\"queries\":{";
+    for (int i = 0; i < static_cast<int>(QueryType::Count); ++i)
+    {
+        const PerType &t = types[i];
+        snprintf(buffer, sizeof(buffer),
+                 "%s\"%s\":{\"count\":%llu,\"latency_us\":{", i ? "," : "", queryTypeName(QueryType(i)),
+                 (unsigned long long)t.latency.count());
+        out += buffer;
+        for (int k = 0; k < 4; ++k)
+        {
+            snprintf(buffer, sizeof(buffer), "\"%s\":%.3f,", kQuantileNames[k], t.latency.percentile(kQuantiles[k]) / 1000.0);
+            out += buffer;
+        }
+        snprintf(buffer, sizeof(buffer),
+                 "\"max\":%.3f,\"mean\":%.3f},\"settled\":%llu,\"heap_pushes\":%llu,\"stale_pops\":%llu,\"edges_skipped\":%llu}",
+                 t.latency.max() / 1000.0, t.latency.count() ? t.latency.sum() / 1000.0 / t.latency.count() : 0.0,
+                 (unsigned long long)t.settled.load(), (unsigned long long)t.heapPushes.load(),
+                 (unsigned long long)t.stalePops.load(), (unsigned long long)t.edgesSkipped.load());
+        out += buffer;
+    }
+    out += "}}\n";
+    return out;
+}
+
+string RoutingMetrics::toPrometheus() const
+{
+    char buffer[256];
+    string out;
+    out += "# HELP routing_query_latency_seconds Route search latency by query type.\n";
+    out += "# TYPE routing_query_latency_seconds summary\n";
+    for (int i = 0; i < static_cast<int>(QueryType::Count); ++i)
+    {
+        const LatencyHistogram &h = types[i].latency;
+        const char *name = queryTypeName(QueryType(i));
+        for (int k = 0; k < 4; ++k)
+        {
+            snprintf(buffer, sizeof(buffer), "routing_query_latency_seconds{type=\"%s\",quantile=\"%g\"} %.9f\n",
+                     name, kQuantiles[k], h.percentile(kQuantiles[k]) / 1e9);
+            out += buffer;
+        }
+        snprintf(buffer, sizeof(buffer), "routing_query_latency_seconds_sum{type=\"%s\"} %.9f\n", name, h.sum() / 1e9);
+        out += buffer;
+        snprintf(buffer, sizeof(buffer), "routing_query_latency_seconds_count{type=\"%s\"} %llu\n", name,
+                 (unsigned long long)h.count());
+        out += buffer;
+    }
+
+    auto counter = [&](const char *metric, const char *help, atomic<uint64_t> PerType::*field)
+    {
+        out += string("# HELP ") + metric + " " + help + "\n";
+        out += string("# TYPE ") + metric + " counter\n";
+        for (int i = 0; i < static_cast<int>(QueryType::Count); ++i)
+        {
+            snprintf(buffer, sizeof(buffer), "%s{type=\"%s\"} %llu\n", metric, queryTypeName(QueryType(i)),
+                     (unsigned long long)(types[i].*field).load());
+            out += buffer;
+        }
+    };
+    counter("routing_nodes_settled_total", "Nodes settled by route searches.", &PerType::settled);
+    counter("routing_heap_pushes_total", "Priority queue pushes by route searches.", &PerType::heapPushes);
+    counter("routing_stale_pops_total", "Outdated priority queue entries popped and skipped.", &PerType::stalePops);
+    counter("routing_edges_skipped_total", "Edges skipped as unavailable.", &PerType::edgesSkipped);
+    return out;
+}
+
+bool RoutingMetrics::writeFile(const string &path) const
+{
+    bool prometheus = path.size() >= 5 && (path.compare(path.size() - 5, 5, ".prom") == 0 ||
+                                           path.compare(path.size() - 4, 4, ".txt") == 0);
+    string text = prometheus ? toPrometheus() : toJson();
+
+    string temp = path + ".tmp";
+    FILE *f = fopen(temp.c_str(), "w");
+    if (!f)
+    return false;
+    bool ok = fwrite(text.data(), 1, text.size(), f) == text.size();
+    ok = fclose(f) == 0 && ok;
+    if (!ok)
+    return false;
+    // Both replace an existing file in one step, so a reader never finds
+    // it missing; Windows' rename() would refuse to.
+#ifdef _WIN32
+    return MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(temp.c_str(), path.c_str()) == 0;
+#endif
+}
+
+RoutingMetrics &routingMetrics()
+{
+    static RoutingMetrics metrics;
+    return metrics;
+}
+
+MetricsExporter::MetricsExporter(string path, int intervalSeconds)
+    : path(move(path)), interval(max(1, intervalSeconds))
+{
+    worker = thread(&MetricsExporter::run, this);
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    {
+        lock_guard<mutex> lock(m);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+    routingMetrics().writeFile(path);
+}
+
+void MetricsExporter::run()
+{
+    unique_lock<mutex> lock(m);
+    while (!wake.wait_for(lock, interval, [this] { return stopping; }))
+    routingMetrics().writeFile(path);
+}
@@ -0,0 +1,144 @@
+#ifndef ROUTING_STATS_H
+#define ROUTING_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Search instrumentation. Build with -DROUTING_STATS=1 to enable it; when
+// disabled (the default) every hook below expands to nothing and searches
+// carry no counters at all.
+#ifndef ROUTING_STATS
+#define ROUTING_STATS 0
+#endif
+
+// What one dijkstra() call did. Lives in the SearchWorkspace and is reset at
+// the start of each search, so after a search it describes that search.
+struct SearchCounters
+{
+    std::uint64_t settled = 0;
+    std::uint64_t heapPushes = 0;
+    std::uint64_t stalePops = 0;
+    std::uint64_t edgesSkipped = 0;
+};
+
+// Direct: the weather-blind search. WeatherAware: the search that avoids
+// bad weather and kept the direct route. Reroute: a weather search that had
+// to leave the direct route.
+enum class QueryType
+{
+    Direct,
+    WeatherAware,
+    Reroute,
+    Count
+};
+
+const char *queryTypeName(QueryType type);
+
+// Log-linear latency histogram in the style of HdrHistogram: values below 16
+// are exact, above that each power of two is split into 16 sub-buckets, so
+// any recorded value is reported within ~6%. Recording is a few relaxed
+// atomic increments and safe from any number of threads.
+class LatencyHistogram
+{
+public:
+    static constexpr int kSubBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBits;
+    static constexpr int kBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+    void record(std::uint64_t value);
+
+    // Upper bound of the bucket holding quantile q (0..1); 0 if empty.
+    std::uint64_t percentile(double q) const;
+
+    std::uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    std::uint64_t sum() const { return valueSum.load(std::memory_order_relaxed); }
+    std::uint64_t max() const { return maximum.load(std::memory_order_relaxed); }
+
+private:
+    static int bucketOf(std::uint64_t value);
+    static std::uint64_t bucketUpperBound(int bucket);
+
+    std::array<std::atomic<std::uint64_t>, kBuckets> buckets{};
+    std::atomic<std::uint64_t> total{0};
+    std::atomic<std::uint64_t> valueSum{0};
+    std::atomic<std::uint64_t> maximum{0};
+};
+
+// Process-wide query metrics: a latency histogram (nanoseconds) and counter
+// totals per query type.
+class RoutingMetrics
+{
+public:
+    struct PerType
+    {
+        LatencyHistogram latency;
+        std::atomic<std::uint64_t> settled{0};
+        std::atomic<std::uint64_t> heapPushes{0};
+        std::atomic<std::uint64_t> stalePops{0};
+        std::atomic<std::uint64_t> edgesSkipped{0};
+    };
+
+    void record(QueryType type, std::uint64_t nanos, const SearchCounters &counters);
+    const PerType &of(QueryType type) const { return types[static_cast<int>(type)]; }
+
+    std::string toJson() const;
+    std::string toPrometheus() const;
+
+    // Writes JSON, or Prometheus text if `path` ends in ".prom" or ".txt".
+    // The file is replaced atomically so a scraper never sees a partial one.
+    bool writeFile(const std::string &path) const;
+
+private:
+    std::array<PerType, static_cast<int>(QueryType::Count)> types;
+};
+
+RoutingMetrics &routingMetrics();
+
+// Rewrites routingMetrics() to `path` every `intervalSeconds` on a
+// background thread, and once more on destruction.
+class MetricsExporter
+{
+public:
+    MetricsExporter(std::string path, int intervalSeconds);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter &) = delete;
+    MetricsExporter &operator=(const MetricsExporter &) = delete;
+
+private:
+    void run();
+
+    std::string path;
+    std::chrono::seconds interval;
+    std::mutex m;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+};
+
+#if ROUTING_STATS
+#define ROUTING_COUNT(ws, field) (++(ws).counters.field)
+#define ROUTING_RESET_COUNTERS(ws) ((ws).counters = SearchCounters())
+#define ROUTING_TIMER(name) auto name = std::chrono::steady_clock::now()
+#define ROUTING_RECORD(name, type, ws)                                                                    \
+    do                                                                                                    \
+    {                                                                                                     \
+        auto routingNow = std::chrono::steady_clock::now();                                               \
+        routingMetrics().record(type, std::chrono::duration_cast<std::chrono::nanoseconds>(routingNow - name).count(), \
+                                (ws).counters);                                                           \
+        name = routingNow;                                                                                \
+    } while (0)
+#else
+#define ROUTING_COUNT(ws, field) ((void)0)
+#define ROUTING_RESET_COUNTERS(ws) ((void)0)
+#define ROUTING_TIMER(name) ((void)0)
+#define ROUTING_RECORD(name, type, ws) ((void)0)
+#endif
+
+#endif
@@ -98,108 +98,12 @@ public:
 
 void writeAlgorithms(ofstream &f)
 {
+    // The algorithms themselves live in run_algorithms.h so that route_bench
+    // benchmarks the same code the generated simulator runs.
     f << R"ALGO(// -------------------------
 // Routing Algorithms
 // -------------------------
-#include <limits>
-#include <unordered_map>
-#include <set>
-
-// Dijkstra's algorithm
-unordered_map<string,double> dijkstra(
-    const unordered_map<string,vector<pair<string,double>>>& graph,
-    const string& src,
-    unordered_map<string,string>& prev) {
-    unordered_map<string,double> dist;
-    set<pair<double,string>> pq;
-    for (auto& p : graph) dist[p.first] = numeric_limits<double>::infinity();
-    dist[src] = 0;
-    pq.insert({0, src});
-    while (!pq.empty()) {
-        auto u = *pq.begin(); pq.erase(pq.begin());
-        string node = u.second;
-        for (auto& nei : graph.at(node)) {
-            double alt = dist[node] + nei.second;
-            if (alt < dist[nei.first]) {
-                pq.erase({dist[nei.first], nei.first});
-                dist[nei.first] = alt;
-                prev[nei.first] = node;
-                pq.insert({alt, nei.first});
-            }
-        }
-    }
-    return dist;
-}
-
-// Bellman-Ford algorithm
-unordered_map<string,double> bellmanFord(
-    const unordered_map<string,vector<pair<string,double>>>& graph,
-    const string& src,
-    unordered_map<string,string>& prev) {
-    unordered_map<string,double> dist;
-    for (auto& p : graph) dist[p.first] = numeric_limits<double>::infinity();
-    dist[src] = 0;
-    for (size_t i = 1; i < graph.size(); ++i) {
-        for (auto& u : graph) {
-            for (auto& e : u.second) {
-                if (dist[u.first] + e.second < dist[e.first]) {
-                    dist[e.first] = dist[u.first] + e.second;
-                    prev[e.first] = u.first;
-                }
-            }
-        }
-    }
-    return dist;
-}
-
-// A* algorithm
-#include <functional>
-
-vector<string> astar(
-    const unordered_map<string,vector<pair<string,double>>>& graph,
-    const string& start,
-    const string& goal,
-    const unordered_map<string,pair<double,double>>& coords) {
-    auto heuristic = [&](const string& a, const string& b) {
-        auto p = coords.at(a);
-        auto q = coords.at(b);
-        return sqrt((p.first - q.first)*(p.first - q.first) + (p.second - q.second)*(p.second - q.second));
-    };
-    unordered_map<string,double> gScore, fScore;
-    unordered_map<string,string> cameFrom;
-    set<pair<double,string>> openSet;
-    for (auto& p : graph) {
-        gScore[p.first] = numeric_limits<double>::infinity();
-        fScore[p.first] = numeric_limits<double>::infinity();
-    }
-    gScore[start] = 0;
-    fScore[start] = heuristic(start, goal);
-    openSet.insert({fScore[start], start});
-    while (!openSet.empty()) {
-        auto cur = *openSet.begin(); openSet.erase(openSet.begin());
-        string node = cur.second;
-        if (node == goal) break;
-        for (auto& nei : graph.at(node)) {
-            double tentative = gScore[node] + nei.second;
-            if (tentative < gScore[nei.first]) {
-                openSet.erase({fScore[nei.first], nei.first});
-                cameFrom[nei.first] = node;
-                gScore[nei.first] = tentative;
-                fScore[nei.first] = tentative + heuristic(nei.first, goal);
-                openSet.insert({fScore[nei.first], nei.first});
-            }
-        }
-    }
-    vector<string> path;
-    string cur = goal;
-    while (cameFrom.count(cur)) {
-        path.push_back(cur);
-        cur = cameFrom[cur];
-    }
-    path.push_back(start);
-    reverse(path.begin(), path.end());
-    return path;
-}
+#include "run_algorithms.h"
 )ALGO";
 }
 
@@ -233,38 +137,39 @@ int main() {
     cin >> src;
     cout << "Enter arrival code: ";
     cin >> dst;
+    // intern the codes once; the loop below searches by integer ID
+    RunGraph run = indexRunGraph(graph, coords);
+    int srcId = run.nodes.find(src), dstId = run.nodes.find(dst);
+    if (srcId < 0 || dstId < 0) {
+        cout << "Unknown airport code" << endl;
+        return 1;
+    }
     WeatherService weather;
     PricingService pricing;
     SeatService seats;
-    unordered_map<string,string> prev;
+    SearchBuffers buffers;
+    // profile the network once, then let measured run times pick the algorithm
+    RunGraphProfile profile = profileRunGraph(run);
+    StrategyTuner tuner = makeRunTuner(profile);
+    const char* algorithmNames[] = { "Dijkstra", "Bellman-Ford", "A*" };
     // simulate loop
     while (true) {
         system("clear");
-        int choice = rand() % 3;
-        vector<string> path;
-        unordered_map<string,double> dist;
-        prev.clear();
-        if (choice == 0) {
-            dist = dijkstra(graph, src, prev);
-            string cur = dst;
-            while (prev.count(cur)) {
-                path.push_back(cur);
-                cur = prev[cur];
-            }
-            path.push_back(src);
-            reverse(path.begin(), path.end());
-        } else if (choice == 1) {
-            dist = bellmanFord(graph, src, prev);
-            string cur = dst;
-            while (prev.count(cur)) {
-                path.push_back(cur);
-                cur = prev[cur];
-            }
-            path.push_back(src);
-            reverse(path.begin(), path.end());
+        int choice = tuner.choose();
+        auto started = chrono::steady_clock::now();
+        vector<int> route;
+        if (choice == RunDijkstra) {
+            dijkstra(run, srcId, buffers);
+            route = searchPath(buffers, srcId, dstId);
+        } else if (choice == RunBellmanFord) {
+            bellmanFord(run, srcId, buffers);
+            route = searchPath(buffers, srcId, dstId);
         } else {
-            path = astar(graph, src, dst, coords);
+            route = astar(run, srcId, dstId, buffers);
         }
+        tuner.record(0, choice, chrono::duration<double, nano>(chrono::steady_clock::now() - started).count());
+        vector<string> path;
+        for (int id : route) path.push_back(run.nodes.name(id));
         double totalDist = 0;
         for (size_t i = 1; i < path.size(); ++i) {
             for (auto& e : graph[path[i-1]]) {
@@ -281,6 +186,9 @@ int main() {
         for (size_t i = 1; i < path.size(); ++i) {
             seatsAvail = min(seatsAvail, seats.get(path[i-1], path[i]));
         }
+        cout << "Network: " << profile.nodes << " airports, density " << profile.density
+             << ", hop diameter " << profile.hopDiameter << ", heuristic tightness " << profile.heuristicTightness << endl;
+        cout << "Algorithm: " << algorithmNames[choice] << " (" << tuner.meanNanos(0, choice) / 1000.0 << " us avg)" << endl;
         cout << "Path: ";
         for (auto& c : path) cout << c << " -> ";
         cout << "END" << endl;
@@ -0,0 +1,232 @@
+#ifndef RUN_ALGORITHMS_H
+#define RUN_ALGORITHMS_H
+
+// Routing algorithms used by the program run.cpp generates. They live here,
+// rather than only inside run.cpp's emitted text, so that route_bench
+// measures exactly the code the generated simulator runs.
+//
+// The searches themselves are graph_core.h's, on a RunGraph whose airport
+// codes were interned once. The string-keyed signatures further down are
+// the original API, kept as thin adapters that index the graph, search and
+// translate the answer back; index once and use the RunGraph overloads to
+// keep strings out of repeated queries.
+//
+// `settled`, when given, receives the number of nodes taken off the queue.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "graph_core.h"
+#include "strategy_tuner.h"
+
+using StringGraph = std::unordered_map<std::string, std::vector<std::pair<std::string, double>>>;
+using CoordMap = std::unordered_map<std::string, std::pair<double, double>>;
+
+// A StringGraph with its node names interned: node i is nodes.name(i).
+struct RunGraph
+{
+    NodeIndex nodes;
+    std::vector<std::vector<std::pair<int, double>>> adj;
+    // Empty unless indexed with coordinates; needed by astar().
+    std::vector<std::pair<double, double>> coords;
+};
+
+// Interns the graph's nodes in its iteration order, then any that only
+// appear as arc targets.
+inline RunGraph indexRunGraph(const StringGraph &graph) {
+    RunGraph run;
+    for (auto &p : graph) run.nodes.intern(p.first);
+    run.adj.resize(run.nodes.size());
+    for (auto &p : graph) {
+        int u = run.nodes.id(p.first);
+        for (auto &e : p.second) {
+            int v = run.nodes.intern(e.first);
+            if (v >= static_cast<int>(run.adj.size())) run.adj.resize(v + 1);
+            run.adj[u].push_back({v, e.second});
+        }
+    }
+    return run;
+}
+
+inline RunGraph indexRunGraph(const StringGraph &graph, const CoordMap &coords) {
+    RunGraph run = indexRunGraph(graph);
+    for (int v = 0; v < run.nodes.size(); ++v) run.coords.push_back(coords.at(run.nodes.name(v)));
+    return run;
+}
+
+// Dijkstra's algorithm: distances and parents from src to every node stay
+// in `buffers` (see searchPath()) until the next search with them.
+inline void dijkstra(const RunGraph &graph, int src, SearchBuffers &buffers, std::size_t *settled = nullptr) {
+    SettledCounter counter;
+    buffers.reset();
+    bestFirstSearch(graph.adj, src, -1, AnyArc(), ZeroHeuristic(), buffers, counter);
+    if (settled) *settled = counter.settled;
+}
+
+// Bellman-Ford algorithm, results in `buffers` as for dijkstra().
+inline void bellmanFord(const RunGraph &graph, int src, SearchBuffers &buffers) {
+    buffers.reset();
+    bellmanFordSearch(graph.adj, src, buffers);
+}
+
+// A* algorithm with straight-line distance between coords as the heuristic.
+// Returns the path, empty if goal is unreachable.
+inline std::vector<int> astar(const RunGraph &graph, int start, int goal, SearchBuffers &buffers,
+                              std::size_t *settled = nullptr) {
+    std::pair<double, double> q = graph.coords[goal];
+    auto heuristic = [&](int v) {
+        std::pair<double, double> p = graph.coords[v];
+        return std::sqrt((p.first - q.first) * (p.first - q.first) + (p.second - q.second) * (p.second - q.second));
+    };
+    SettledCounter counter;
+    buffers.reset();
+    bestFirstSearch(graph.adj, start, goal, AnyArc(), heuristic, buffers, counter);
+    if (settled) *settled = counter.settled;
+    return searchPath(buffers, start, goal);
+}
+
+// Dijkstra's algorithm
+inline std::unordered_map<std::string, double> dijkstra(
+    const StringGraph &graph,
+    const std::string &src,
+    std::unordered_map<std::string, std::string> &prev,
+    std::size_t *settled = nullptr)
+{
+    RunGraph run = indexRunGraph(graph);
+    SearchBuffers buffers;
+    dijkstra(run, run.nodes.id(src), buffers, settled);
+    std::unordered_map<std::string, double> dist;
+    for (int v = 0; v < run.nodes.size(); ++v) {
+        dist[run.nodes.name(v)] = buffers.dist[v];
+        if (buffers.prev[v] >= 0) prev[run.nodes.name(v)] = run.nodes.name(buffers.prev[v]);
+    }
+    return dist;
+}
+
+// Bellman-Ford algorithm
+inline std::unordered_map<std::string, double> bellmanFord(
+    const StringGraph &graph,
+    const std::string &src,
+    std::unordered_map<std::string, std::string> &prev) {
+    RunGraph run = indexRunGraph(graph);
+    SearchBuffers buffers;
+    bellmanFord(run, run.nodes.id(src), buffers);
+    std::unordered_map<std::string, double> dist;
+    for (int v = 0; v < run.nodes.size(); ++v) {
+        dist[run.nodes.name(v)] = buffers.dist[v];
+        if (buffers.prev[v] >= 0) prev[run.nodes.name(v)] = run.nodes.name(buffers.prev[v]);
+    }
+    return dist;
+}
+
+// A* algorithm. As before, an unreachable goal gives just {start}.
+inline std::vector<std::string> astar(
+    const StringGraph &graph,
+    const std::string &start,
+    const std::string &goal,
+    const CoordMap &coords,
+    std::size_t *settled = nullptr) {
+    RunGraph run = indexRunGraph(graph, coords);
+    SearchBuffers buffers;
+    std::vector<int> ids = astar(run, run.nodes.id(start), run.nodes.id(goal), buffers, settled);
+    std::vector<std::string> path;
+    for (int v : ids) path.push_back(run.nodes.name(v));
+    if (path.empty()) path.push_back(start);
+    return path;
+}
+
+// Algorithms the generated simulator chooses between, in StrategyTuner order.
+enum RunAlgorithm
+{
+    RunDijkstra,
+    RunBellmanFord,
+    RunAStar,
+    RunAlgorithmCount
+};
+
+struct RunGraphProfile
+{
+    std::size_t nodes;
+    std::size_t arcs;
+    double density;
+    int hopDiameter;
+    // Mean straight-line / shortest distance over pairs from a few sources.
+    double heuristicTightness;
+    // astar() is only exact when straight-line distance never overestimates.
+    bool heuristicAdmissible;
+};
+
+// Expects `graph` indexed with coordinates.
+inline RunGraphProfile profileRunGraph(const RunGraph &graph) {
+    int n = graph.nodes.size();
+    RunGraphProfile profile = {static_cast<std::size_t>(n), 0, 0, 0, 0, true};
+    if (n == 0) return profile;
+    auto straightLine = [&](int a, int b) {
+        std::pair<double, double> p = graph.coords[a];
+        std::pair<double, double> q = graph.coords[b];
+        return std::sqrt((p.first - q.first) * (p.first - q.first) + (p.second - q.second) * (p.second - q.second));
+    };
+    for (int u = 0; u < n; ++u) {
+        profile.arcs += graph.adj[u].size();
+        for (auto &e : graph.adj[u])
+            if (straightLine(u, e.first) > e.second) profile.heuristicAdmissible = false;
+    }
+    profile.density = n > 1 ? profile.arcs / (static_cast<double>(n) * (n - 1)) : 0;
+
+    // Double-sweep BFS: the farthest node from anywhere, then from there.
+    int from = 0;
+    std::vector<int> depth(n);
+    for (int sweep = 0; sweep < 2; ++sweep) {
+        depth.assign(n, -1);
+        std::deque<int> frontier(1, from);
+        depth[from] = 0;
+        while (!frontier.empty()) {
+            int u = frontier.front(); frontier.pop_front();
+            if (depth[u] > depth[from]) from = u;
+            for (auto &e : graph.adj[u])
+                if (depth[e.first] < 0) {
+                    depth[e.first] = depth[u] + 1;
+                    frontier.push_back(e.first);
+                }
+        }
+        profile.hopDiameter = depth[from];
+    }
+
+    double ratioSum = 0;
+    std::size_t pairs = 0;
+    SearchBuffers buffers;
+    for (int source = 0; source < 3 && source < n; ++source) {
+        dijkstra(graph, source, buffers);
+        for (int v = 0; v < n; ++v) {
+            double d = buffers.dist[v];
+            if (d > 0 && d < std::numeric_limits<double>::infinity()) {
+                ratioSum += std::min(1.0, straightLine(source, v) / d);
+                ++pairs;
+            }
+        }
+    }
+    profile.heuristicTightness = pairs ? ratioSum / pairs : 0;
+    return profile;
+}
+
+inline RunGraphProfile profileRunGraph(const StringGraph &graph, const CoordMap &coords) {
+    return profileRunGraph(indexRunGraph(graph, coords));
+}
+
+// A tuner over RunAlgorithm with the algorithms the profile rules out
+// disabled: astar() when its heuristic could overestimate, and bellmanFord()
+// once its V*E relaxations per query outgrow a small budget.
+inline StrategyTuner makeRunTuner(const RunGraphProfile &profile) {
+    StrategyTuner tuner(RunAlgorithmCount);
+    tuner.setEnabled(RunAStar, profile.heuristicAdmissible);
+    tuner.setEnabled(RunBellmanFord, static_cast<double>(profile.nodes) * profile.arcs <= 1e6);
+    return tuner;
+}
+
+#endif
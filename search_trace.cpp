@@ -0,0 +1,92 @@
+#include "search_trace.h"
+#include <algorithm>
+using namespace std;
+
+SearchTrace::SearchTrace(size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity)
+    size <<= 1;
+    buffer.resize(size);
+    mask = size - 1;
+}
+
+SearchReplay::SearchReplay(const SearchTrace &trace, int nodes)
+    : trace(trace), states(nodes, Unseen), parents(nodes, -1)
+{
+    long long start = trace.lastSearch();
+    if (start < 0)
+    return;
+    first = start;
+    count = trace.size() - first;
+    src = trace[first].node;
+    dst = trace[first].other();
+}
+
+void SearchReplay::apply(const SearchEvent &event)
+{
+    int v = event.node;
+    switch (event.kind())
+    {
+    case SearchEvent::Begin:
+        states[v] = Frontier;
+        touched.push_back(v);
+        break;
+    case SearchEvent::Settle:
+        if (states[v] != Settled)
+        ++settled;
+        states[v] = Settled;
+        parents[v] = event.other();
+        break;
+    case SearchEvent::Relax:
+        if (states[v] == Unseen)
+        touched.push_back(v);
+        states[v] = Frontier;
+        parents[v] = event.other();
+        break;
+    case SearchEvent::Blocked:
+        break;
+    }
+}
+
+size_t SearchReplay::advance(size_t events)
+{
+    size_t n = min(events, count - applied);
+    for (size_t i = 0; i < n; ++i)
+    apply(trace[first + applied + i]);
+    applied += n;
+    return n;
+}
+
+void SearchReplay::seek(size_t position)
+{
+    position = min(position, count);
+    if (position < applied)
+    {
+        for (int v : touched)
+        {
+            states[v] = Unseen;
+            parents[v] = -1;
+        }
+        touched.clear();
+        applied = 0;
+        settled = 0;
+    }
+    advance(position - applied);
+}
+
+const SearchEvent *SearchReplay::lastEvent() const
+{
+    return applied ? &trace[first + applied - 1] : nullptr;
+}
+
+vector<int> SearchReplay::path() const
+{
+    vector<int> route;
+    if (dst < 0 || (dst != src && parents[dst] == -1))
+    return route;
+    for (int at = dst; at != -1 && route.size() <= parents.size(); at = parents[at])
+    route.push_back(at);
+    reverse(route.begin(), route.end());
+    return route;
+}
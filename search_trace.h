@@ -0,0 +1,145 @@
+#ifndef SEARCH_TRACE_H
+#define SEARCH_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Step-by-step record of what dijkstra() did, for playing a search back on
+// screen. Attach a SearchTrace to a SearchWorkspace (ws.trace = &trace) and
+// every search through that workspace appends its events; a workspace
+// without one runs a separately instantiated search with no recording code
+// in it at all.
+
+// One 8-byte event: the node it concerns, plus the kind and a second node
+// packed into the other word. Node indices must be below kNoNode.
+struct SearchEvent
+{
+    enum Kind : std::uint32_t
+    {
+        Begin,   // node = src, other = dst
+        Settle,  // node popped with its final distance; other = its parent
+        Relax,   // edge other -> node improved node's distance
+        Blocked  // edge other -> node skipped as unavailable
+    };
+
+    static const std::uint32_t kNoNode = (1u << 30) - 1;
+
+    std::uint32_t node;
+    std::uint32_t packed;
+
+    Kind kind() const { return static_cast<Kind>(packed >> 30); }
+    int other() const
+    {
+        std::uint32_t value = packed & kNoNode;
+        return value == kNoNode ? -1 : static_cast<int>(value);
+    }
+};
+
+static_assert(sizeof(SearchEvent) == 8, "SearchEvent must stay 8 bytes");
+
+// Fixed-size ring of events, allocated once. When it fills up the oldest
+// events are overwritten, so recording never allocates or fails.
+class SearchTrace
+{
+public:
+    // Capacity is rounded up to a power of two.
+    explicit SearchTrace(std::size_t capacity = 1 << 20);
+
+    void begin(int src, int dst)
+    {
+        lastBegin = head;
+        push(src, SearchEvent::Begin, dst);
+    }
+    void settle(int u, int parent) { push(u, SearchEvent::Settle, parent); }
+    void relax(int v, int from) { push(v, SearchEvent::Relax, from); }
+    void blocked(int v, int from) { push(v, SearchEvent::Blocked, from); }
+
+    void clear() { head = lastBegin = 0; }
+
+    // Events currently held, oldest first.
+    std::size_t size() const { return head < buffer.size() ? head : buffer.size(); }
+    const SearchEvent &operator[](std::size_t i) const { return buffer[(head - size() + i) & mask]; }
+
+    std::size_t capacity() const { return buffer.size(); }
+    std::uint64_t recorded() const { return head; }
+    std::uint64_t overwritten() const { return head - size(); }
+
+    // Index (as for operator[]) of the most recent search's Begin event, or
+    // -1 if no search was recorded or its start has been overwritten.
+    long long lastSearch() const
+    {
+        if (head == 0 || lastBegin < overwritten())
+        return -1;
+        return static_cast<long long>(lastBegin - overwritten());
+    }
+
+private:
+    void push(int node, SearchEvent::Kind kind, int other)
+    {
+        std::uint32_t packedOther = other < 0 ? SearchEvent::kNoNode : static_cast<std::uint32_t>(other);
+        buffer[head++ & mask] = {static_cast<std::uint32_t>(node), kind << 30 | packedOther};
+    }
+
+    std::vector<SearchEvent> buffer;
+    std::size_t mask;
+    std::uint64_t head = 0;
+    std::uint64_t lastBegin = 0;
+};
+
+// Plays one recorded search forward (or back) event by event, keeping the
+// state of each node and the current shortest-path tree. Stepping costs O(1)
+// per event whatever the graph size; seeking backwards replays from the
+// start of the search.
+class SearchReplay
+{
+public:
+    enum NodeState : std::uint8_t
+    {
+        Unseen,
+        Frontier,
+        Settled
+    };
+
+    // Replays the most recent search in `trace`, which must outlive the
+    // replay and not be recorded into while it is in use.
+    SearchReplay(const SearchTrace &trace, int nodes);
+
+    // Applies up to `events` more events; returns how many were applied.
+    std::size_t advance(std::size_t events);
+    void seek(std::size_t position);
+    void restart() { seek(0); }
+
+    std::size_t position() const { return applied; }
+    std::size_t length() const { return count; }
+    bool done() const { return applied == count; }
+
+    int source() const { return src; }
+    int target() const { return dst; }
+    NodeState state(int v) const { return static_cast<NodeState>(states[v]); }
+    // Tree edge into v as of the current position, or -1.
+    int parent(int v) const { return parents[v]; }
+    std::size_t settledCount() const { return settled; }
+
+    // The event applied last, if any.
+    const SearchEvent *lastEvent() const;
+
+    // Route to the target along the current tree; empty until it is reached.
+    std::vector<int> path() const;
+
+private:
+    void apply(const SearchEvent &event);
+
+    const SearchTrace &trace;
+    std::size_t first = 0;
+    std::size_t count = 0;
+    std::size_t applied = 0;
+    int src = -1;
+    int dst = -1;
+    std::vector<std::uint8_t> states;
+    std::vector<int> parents;
+    std::vector<int> touched;
+    std::size_t settled = 0;
+};
+
+#endif
@@ -0,0 +1,350 @@
+#include "sim_channel.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+namespace
+{
+const uint32_t kMagic = 0x464c5331; // "FLS1"
+}
+
+// Layout of the mapping. head is only advanced by producers (under
+// producerLock), tail only by the consumer; both count messages ever
+// written/read, so head - tail is the ring occupancy.
+struct SimChannelShared
+{
+    atomic<uint32_t> magic;
+    atomic<uint32_t> producerLock;
+    atomic<uint32_t> consumerSleeping;
+    atomic<uint32_t> consumerAlive;
+    atomic<int64_t> ownerPid;
+    alignas(64) atomic<uint64_t> head;
+    alignas(64) atomic<uint64_t> tail;
+#ifndef _WIN32
+    sem_t doorbell;
+#endif
+    SimMessage slots[SimChannel::kCapacity];
+};
+
+SimChannel::~SimChannel()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool SimChannel::create(const string &channelName)
+{
+    close();
+    name = "Local\\" + channelName;
+    HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                       sizeof(SimChannelShared), name.c_str());
+    if (!handle)
+    return false;
+    if (GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        // Another simulator already owns this channel.
+        CloseHandle(handle);
+        return false;
+    }
+    void *view = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SimChannelShared));
+    HANDLE event = CreateEventA(nullptr, FALSE, FALSE, (name + ".doorbell").c_str());
+    if (!view || !event)
+    {
+        if (view)
+        UnmapViewOfFile(view);
+        if (event)
+        CloseHandle(event);
+        CloseHandle(handle);
+        return false;
+    }
+
+    shared = new (view) SimChannelShared();
+    shared->ownerPid = static_cast<int64_t>(GetCurrentProcessId());
+    shared->consumerAlive = 1;
+    shared->magic.store(kMagic, memory_order_release);
+    mapping = handle;
+    doorbell = event;
+    owner = true;
+    return true;
+}
+
+bool SimChannel::open(const string &channelName)
+{
+    close();
+    name = "Local\\" + channelName;
+    HANDLE handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+    if (!handle)
+    return false;
+    void *view = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SimChannelShared));
+    HANDLE event = OpenEventA(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, (name + ".doorbell").c_str());
+    if (!view || !event || static_cast<SimChannelShared *>(view)->magic.load(memory_order_acquire) != kMagic)
+    {
+        if (view)
+        UnmapViewOfFile(view);
+        if (event)
+        CloseHandle(event);
+        CloseHandle(handle);
+        return false;
+    }
+    shared = static_cast<SimChannelShared *>(view);
+    mapping = handle;
+    doorbell = event;
+    owner = false;
+    return true;
+}
+
+void SimChannel::close()
+{
+    if (!shared)
+    return;
+    if (owner)
+    shared->consumerAlive = 0;
+    UnmapViewOfFile(shared);
+    CloseHandle(static_cast<HANDLE>(doorbell));
+    CloseHandle(static_cast<HANDLE>(mapping));
+    shared = nullptr;
+    mapping = doorbell = nullptr;
+}
+
+void SimChannel::ring()
+{
+    SetEvent(static_cast<HANDLE>(doorbell));
+}
+
+bool SimChannel::waitDoorbell(int timeoutMs)
+{
+    return WaitForSingleObject(static_cast<HANDLE>(doorbell), timeoutMs < 0 ? INFINITE : DWORD(timeoutMs)) == WAIT_OBJECT_0;
+}
+
+#else
+
+bool SimChannel::create(const string &channelName)
+{
+    close();
+    name = "/" + channelName;
+
+    // A previous daemon that crashed leaves its segment behind; only refuse
+    // to start if its owner is still running.
+    int existing = shm_open(name.c_str(), O_RDWR, 0600);
+    if (existing >= 0)
+    {
+        void *view = mmap(nullptr, sizeof(SimChannelShared), PROT_READ, MAP_SHARED, existing, 0);
+        ::close(existing);
+        if (view != MAP_FAILED)
+        {
+            auto *old = static_cast<SimChannelShared *>(view);
+            bool running = old->magic.load() == kMagic && old->consumerAlive.load() &&
+                           kill(static_cast<pid_t>(old->ownerPid.load()), 0) == 0;
+            munmap(view, sizeof(SimChannelShared));
+            if (running)
+            return false;
+        }
+        shm_unlink(name.c_str());
+    }
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    return false;
+    if (ftruncate(fd, sizeof(SimChannelShared)) != 0)
+    {
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void *view = mmap(nullptr, sizeof(SimChannelShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED)
+    {
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    shared = new (view) SimChannelShared();
+    sem_init(&shared->doorbell, 1, 0);
+    shared->ownerPid = static_cast<int64_t>(getpid());
+    shared->consumerAlive = 1;
+    shared->magic.store(kMagic, memory_order_release);
+    owner = true;
+    return true;
+}
+
+bool SimChannel::open(const string &channelName)
+{
+    close();
+    name = "/" + channelName;
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0)
+    return false;
+    void *view = mmap(nullptr, sizeof(SimChannelShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED)
+    return false;
+
+    auto *candidate = static_cast<SimChannelShared *>(view);
+    if (candidate->magic.load(memory_order_acquire) != kMagic || !candidate->consumerAlive.load() ||
+        kill(static_cast<pid_t>(candidate->ownerPid.load()), 0) != 0)
+    {
+        munmap(view, sizeof(SimChannelShared));
+        return false;
+    }
+    shared = candidate;
+    owner = false;
+    return true;
+}
+
+void SimChannel::close()
+{
+    if (!shared)
+    return;
+    if (owner)
+    {
+        shared->consumerAlive = 0;
+        shm_unlink(name.c_str());
+    }
+    munmap(shared, sizeof(SimChannelShared));
+    shared = nullptr;
+}
+
+void SimChannel::ring()
+{
+    sem_post(&shared->doorbell);
+}
+
+bool SimChannel::waitDoorbell(int timeoutMs)
+{
+    if (timeoutMs < 0)
+    {
+        while (sem_wait(&shared->doorbell) != 0)
+        if (errno != EINTR)
+        return false;
+        return true;
+    }
+
+    timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeoutMs / 1000;
+    deadline.tv_nsec += long(timeoutMs % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000)
+    {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000;
+    }
+    while (sem_timedwait(&shared->doorbell, &deadline) != 0)
+    if (errno != EINTR)
+    return false;
+    return true;
+}
+
+#endif
+
+bool SimChannel::push(const SimMessage &message, int timeoutMs)
+{
+    if (!shared)
+    return false;
+
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+    for (;;)
+    {
+        if (!shared->consumerAlive.load(memory_order_acquire))
+        return false;
+
+        uint32_t unlocked = 0;
+        if (shared->producerLock.compare_exchange_weak(unlocked, 1, memory_order_acquire))
+        {
+            uint64_t head = shared->head.load(memory_order_relaxed);
+            if (head - shared->tail.load(memory_order_acquire) < kCapacity)
+            {
+                shared->slots[head % kCapacity] = message;
+                shared->head.store(head + 1, memory_order_seq_cst);
+                shared->producerLock.store(0, memory_order_release);
+
+                // Pairs with the consumer setting consumerSleeping before
+                // re-checking head: one of the two always sees the other.
+                if (shared->consumerSleeping.exchange(0, memory_order_seq_cst))
+                ring();
+                return true;
+            }
+            shared->producerLock.store(0, memory_order_release);
+        }
+
+        if (chrono::steady_clock::now() >= deadline)
+        return false;
+        this_thread::yield();
+    }
+}
+
+bool SimChannel::pushRoute(int src, int dst)
+{
+    SimMessage message{};
+    message.type = SimMessage::Route;
+    message.u = src;
+    message.v = dst;
+    return push(message);
+}
+
+bool SimChannel::pushWeather(int u, int v, bool isBad, const string &description)
+{
+    SimMessage message{};
+    message.type = SimMessage::Weather;
+    message.u = u;
+    message.v = v;
+    message.isBad = isBad;
+    strncpy(message.description, description.c_str(), sizeof(message.description) - 1);
+    return push(message);
+}
+
+bool SimChannel::pop(SimMessage &message, int timeoutMs)
+{
+    if (!shared)
+    return false;
+
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+    for (;;)
+    {
+        uint64_t tail = shared->tail.load(memory_order_relaxed);
+        if (shared->head.load(memory_order_acquire) != tail)
+        {
+            message = shared->slots[tail % kCapacity];
+            shared->tail.store(tail + 1, memory_order_release);
+            return true;
+        }
+
+        shared->consumerSleeping.store(1, memory_order_seq_cst);
+        if (shared->head.load(memory_order_seq_cst) != tail)
+        {
+            shared->consumerSleeping.store(0, memory_order_relaxed);
+            continue;
+        }
+
+        int waitMs = -1;
+        if (timeoutMs >= 0)
+        {
+            auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+            if (left <= 0)
+            {
+                shared->consumerSleeping.store(0, memory_order_relaxed);
+                return false;
+            }
+            waitMs = static_cast<int>(left);
+        }
+        waitDoorbell(waitMs);
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef SIM_CHANNEL_H
+#define SIM_CHANNEL_H
+
+#include <cstdint>
+#include <string>
+
+// Message passed from the booking tool to the resident simulator. Kept
+// trivially copyable and fixed-size so it can live in shared memory.
+struct SimMessage
+{
+    enum Type : std::uint32_t
+    {
+        Route = 1,
+        Weather = 2,
+        Shutdown = 3
+    };
+
+    std::uint32_t type;
+    std::int32_t u;
+    std::int32_t v;
+    std::uint32_t isBad;
+    char description[64];
+};
+
+struct SimChannelShared;
+
+// Single-consumer ring buffer of SimMessages in named shared memory, with a
+// doorbell the consumer sleeps on while the ring is empty. The simulator
+// daemon create()s the channel; booking tools open() it and push(). Pushes
+// from several processes are serialised by a spinlock in the mapping, and
+// the doorbell is only rung when the consumer is actually asleep, so a
+// handoff costs a few atomic operations and at most one kernel call.
+//
+// The spinlock is only held to copy one message into the ring, but a
+// producer killed in that window leaves it held: later pushes then time out
+// and fail until the simulator is restarted, which creates a fresh mapping.
+//
+// This header deliberately includes nothing from the routing library so the
+// booking tool, which has its own Airport type, can use it.
+class SimChannel
+{
+public:
+    static constexpr std::uint32_t kCapacity = 256;
+
+    SimChannel() = default;
+    ~SimChannel();
+
+    SimChannel(const SimChannel &) = delete;
+    SimChannel &operator=(const SimChannel &) = delete;
+
+    // Creates the channel (consumer side). Fails if it cannot be mapped.
+    bool create(const std::string &name = "FlightSimulatorChannel");
+
+    // Attaches to a channel created by a running consumer. Fails if none is
+    // running.
+    bool open(const std::string &name = "FlightSimulatorChannel");
+
+    bool isOpen() const { return shared != nullptr; }
+
+    // Enqueues a message; returns false if the ring stays full (or the
+    // producer lock stays taken) for `timeoutMs`, or the consumer has gone
+    // away.
+    bool push(const SimMessage &message, int timeoutMs = 1000);
+
+    bool pushRoute(int src, int dst);
+    bool pushWeather(int u, int v, bool isBad, const std::string &description);
+
+    // Dequeues the next message, sleeping on the doorbell for up to
+    // `timeoutMs` (negative waits forever). Consumer side only.
+    bool pop(SimMessage &message, int timeoutMs = -1);
+
+    void close();
+
+private:
+    void ring();
+    bool waitDoorbell(int timeoutMs);
+
+    SimChannelShared *shared = nullptr;
+    bool owner = false;
+    std::string name;
+    void *mapping = nullptr;
+    void *doorbell = nullptr;
+};
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef STRATEGY_TUNER_H
+#define STRATEGY_TUNER_H
+
+#include <cstddef>
+#include <vector>
+
+// Chooses between interchangeable implementations of the same query by their
+// measured run time. Queries are split into classes (e.g. short and long
+// routes) that are tuned separately. Every enabled strategy is timed kWarmup
+// times per class; after that the one with the lowest moving average runs.
+// Alternatives are re-timed now and then so the choice follows the graph
+// and the weather as they change: one is due again once the queries since
+// its last run, at the fastest strategy's cost, add up to kExploreShare
+// times its own cost. Exploring thus takes about 1/kExploreShare of the
+// run time whether an alternative is close behind or far slower.
+//
+// Not thread-safe: keep one per thread, like a SearchWorkspace. Written
+// against C++11 so the program run.cpp generates can use it too.
+class StrategyTuner
+{
+public:
+    static const int kWarmup = 3;
+    static const int kExploreShare = 16;
+
+    explicit StrategyTuner(int strategies, int classes = 1)
+        : strategies(strategies), enabled(strategies, true),
+          arms(static_cast<std::size_t>(strategies) * classes), queries(classes, 0)
+    {
+    }
+
+    int strategyCount() const { return strategies; }
+    int classCount() const { return static_cast<int>(queries.size()); }
+
+    void setEnabled(int strategy, bool on) { enabled[strategy] = on; }
+    bool isEnabled(int strategy) const { return enabled[strategy]; }
+
+    int choose(int queryClass = 0)
+    {
+        const Arm *row = &arms[static_cast<std::size_t>(queryClass) * strategies];
+        long long n = ++queries[queryClass];
+        for (int s = 0; s < strategies; ++s)
+        if (enabled[s] && row[s].samples < kWarmup)
+        return s;
+
+        int fastest = best(queryClass);
+        if (fastest < 0)
+        return 0;
+        int due = -1;
+        for (int s = 0; s < strategies; ++s)
+        if (enabled[s] && s != fastest &&
+            (n - row[s].lastQuery) * row[fastest].meanNanos >= kExploreShare * row[s].meanNanos &&
+            (due < 0 || row[s].lastQuery < row[due].lastQuery))
+        due = s;
+        return due >= 0 ? due : fastest;
+    }
+
+    void record(int queryClass, int strategy, double nanos)
+    {
+        Arm &arm = arms[static_cast<std::size_t>(queryClass) * strategies + strategy];
+        ++arm.samples;
+        // A plain mean while warming up, then an exponential moving average.
+        double weight = arm.samples <= kWarmup ? 1.0 / arm.samples : 0.125;
+        arm.meanNanos += (nanos - arm.meanNanos) * weight;
+        arm.lastQuery = queries[queryClass];
+    }
+
+    // Fastest enabled strategy measured so far for the class, or -1.
+    int best(int queryClass) const
+    {
+        const Arm *row = &arms[static_cast<std::size_t>(queryClass) * strategies];
+        int fastest = -1;
+        for (int s = 0; s < strategies; ++s)
+        if (enabled[s] && row[s].samples > 0 && (fastest < 0 || row[s].meanNanos < row[fastest].meanNanos))
+        fastest = s;
+        return fastest;
+    }
+
+    double meanNanos(int queryClass, int strategy) const { return arm(queryClass, strategy).meanNanos; }
+    long long timesChosen(int queryClass, int strategy) const { return arm(queryClass, strategy).samples; }
+
+private:
+    struct Arm
+    {
+        Arm() : meanNanos(0), samples(0), lastQuery(0) {}
+        double meanNanos;
+        long long samples;
+        long long lastQuery;
+    };
+
+    const Arm &arm(int queryClass, int strategy) const
+    {
+        return arms[static_cast<std::size_t>(queryClass) * strategies + strategy];
+    }
+
+    int strategies;
+    std::vector<bool> enabled;
+    std::vector<Arm> arms;
+    std::vector<long long> queries;
+};
+
+#endif
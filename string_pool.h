@@ -0,0 +1,67 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Handle to a string interned in a StringPool. Handles are dense, start at 0
+// and stay valid for the lifetime of the pool.
+using StrId = std::uint32_t;
+
+// Interning table for airport codes, names and weather descriptions.
+// Characters live in a monotonic arena and are only released when the pool
+// itself is destroyed, so interning never frees and views never dangle.
+class StringPool
+{
+public:
+    explicit StringPool(std::size_t initialBytes = 4096)
+        : arena(initialBytes)
+    {
+        intern("");
+    }
+
+    StringPool(const StringPool &) = delete;
+    StringPool &operator=(const StringPool &) = delete;
+
+    StrId intern(std::string_view s)
+    {
+        auto it = index.find(s);
+        if (it != index.end())
+            return it->second;
+
+        char *storage = static_cast<char *>(arena.allocate(s.size() + 1, 1));
+        std::memcpy(storage, s.data(), s.size());
+        storage[s.size()] = '\0';
+
+        StrId id = static_cast<StrId>(strings.size());
+        std::string_view stored(storage, s.size());
+        strings.push_back(stored);
+        index.emplace(stored, id);
+        return id;
+    }
+
+    // Returns true and sets `id` if `s` has already been interned.
+    bool find(std::string_view s, StrId &id) const
+    {
+        auto it = index.find(s);
+        if (it == index.end())
+            return false;
+        id = it->second;
+        return true;
+    }
+
+    std::string_view view(StrId id) const { return strings[id]; }
+    const char *c_str(StrId id) const { return strings[id].data(); }
+    std::size_t size() const { return strings.size(); }
+
+private:
+    std::pmr::monotonic_buffer_resource arena;
+    std::vector<std::string_view> strings;
+    std::unordered_map<std::string_view, StrId> index;
+};
+
+#endif
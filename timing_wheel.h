@@ -0,0 +1,180 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Hierarchical timing wheel: an event queue for integer tick timestamps with
+// O(1) scheduling. Level L has 256 slots, each covering 256^L ticks; an
+// event sits on the lowest level whose slot still lies ahead of now(), and
+// moves down a level each time the wheel reaches its slot, so it is touched
+// at most kLevels times in all. Level 0 slots hold a single tick, and an
+// occupancy bitmap per level lets the wheel jump straight over empty
+// stretches. Events more than 2^32 ticks out wait in an overflow list.
+//
+// Events due at the same tick fire in no particular order, but in the same
+// order on every run.
+template <typename T>
+class TimingWheel
+{
+public:
+    static const int kLevels = 4;
+    static const int kSlotBits = 8;
+    static const int kSlots = 1 << kSlotBits;
+
+    explicit TimingWheel(std::uint64_t start = 0) : current(start) {}
+
+    // Every event before now() has fired; it never passes a runUntil() limit.
+    std::uint64_t now() const { return current; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Schedules `item` at `time`; times before now() fire at now().
+    void schedule(std::uint64_t time, T item)
+    {
+        insert({std::max(time, current), std::move(item)});
+        ++count;
+    }
+
+    // Fires every event due at or before `until` in time order, calling
+    // fire(time, item). fire() may schedule further events, including ones
+    // at the current time. Returns the number of events fired.
+    template <typename Fire>
+    std::size_t runUntil(std::uint64_t until, Fire &&fire)
+    {
+        std::size_t fired = 0;
+        std::uint64_t due;
+        while (nextDue(until, due) && due <= until)
+        {
+            current = due;
+            std::vector<Entry> &slot = levels[0][due & (kSlots - 1)];
+            clearBit(0, due & (kSlots - 1));
+            // Swap the slot out so events scheduled for this same tick
+            // during fire() land in a fresh slot and are picked up next.
+            firing.swap(slot);
+            count -= firing.size();
+            for (Entry &entry : firing)
+            fire(due, entry.item);
+            fired += firing.size();
+            firing.clear();
+        }
+        return fired;
+    }
+
+private:
+    struct Entry
+    {
+        std::uint64_t time;
+        T item;
+    };
+
+    static int digit(std::uint64_t time, int level)
+    {
+        return static_cast<int>((time >> (level * kSlotBits)) & (kSlots - 1));
+    }
+
+    void insert(Entry entry)
+    {
+        // Lowest level whose higher digits agree with now(): the entry's
+        // digit at that level is then ahead of now()'s.
+        for (int level = 0; level < kLevels; ++level)
+        if ((entry.time >> ((level + 1) * kSlotBits)) == (current >> ((level + 1) * kSlotBits)))
+        {
+            int slot = digit(entry.time, level);
+            levels[level][slot].push_back(std::move(entry));
+            setBit(level, slot);
+            return;
+        }
+        overflow.push_back(std::move(entry));
+    }
+
+    // Finds the next tick with events, moving events down the levels as the
+    // wheel turns towards them but never turning past `limit`. Returns false
+    // when nothing is due by then.
+    bool nextDue(std::uint64_t limit, std::uint64_t &due)
+    {
+        while (count > 0)
+        {
+            int slot = firstSetFrom(0, digit(current, 0));
+            if (slot >= 0)
+            {
+                due = (current & ~std::uint64_t(kSlots - 1)) | std::uint64_t(slot);
+                return true;
+            }
+
+            bool cascaded = false;
+            for (int level = 1; level < kLevels && !cascaded; ++level)
+            {
+                slot = firstSetFrom(level, digit(current, level) + 1);
+                if (slot < 0)
+                continue;
+                // Jump to the start of that slot and spread its events over
+                // the levels below.
+                int shift = level * kSlotBits;
+                std::uint64_t high = current >> (shift + kSlotBits);
+                std::uint64_t start = (high << kSlotBits | std::uint64_t(slot)) << shift;
+                if (start > limit)
+                return false;
+                current = start;
+                cascade(level, slot);
+                cascaded = true;
+            }
+            if (cascaded)
+            continue;
+
+            // Only far-future events remain.
+            std::uint64_t earliest = overflow.front().time;
+            for (const Entry &entry : overflow)
+            earliest = std::min(earliest, entry.time);
+            if (earliest > limit)
+            return false;
+            current = earliest;
+            std::vector<Entry> pending;
+            pending.swap(overflow);
+            for (Entry &entry : pending)
+            insert(std::move(entry));
+        }
+        return false;
+    }
+
+    void cascade(int level, int slot)
+    {
+        clearBit(level, slot);
+        std::vector<Entry> moving;
+        moving.swap(levels[level][slot]);
+        for (Entry &entry : moving)
+        insert(std::move(entry));
+        // Hand the capacity back so the slot does not reallocate next turn.
+        moving.clear();
+        levels[level][slot].swap(moving);
+    }
+
+    void setBit(int level, int slot) { occupied[level][slot >> 6] |= std::uint64_t(1) << (slot & 63); }
+    void clearBit(int level, int slot) { occupied[level][slot >> 6] &= ~(std::uint64_t(1) << (slot & 63)); }
+
+    // First occupied slot at or after `from` on a level, or -1.
+    int firstSetFrom(int level, int from) const
+    {
+        for (int word = from >> 6; word < kSlots / 64; ++word)
+        {
+            std::uint64_t bits = occupied[level][word];
+            if (word == from >> 6)
+            bits &= ~std::uint64_t(0) << (from & 63);
+            if (bits)
+            return word * 64 + __builtin_ctzll(bits);
+        }
+        return -1;
+    }
+
+    std::uint64_t current;
+    std::size_t count = 0;
+    std::vector<Entry> levels[kLevels][kSlots];
+    std::uint64_t occupied[kLevels][kSlots / 64] = {};
+    std::vector<Entry> overflow;
+    std::vector<Entry> firing;
+};
+
+#endif
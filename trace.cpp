@@ -0,0 +1,155 @@
+#include "trace.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+using namespace std;
+
+atomic<bool> traceActive{false};
+
+namespace
+{
+struct TraceEvent
+{
+    const char *name;
+    const char *category;
+    int64_t start;
+    int64_t end;
+};
+
+// One per thread that has recorded anything. The mutex is only contended
+// while a session is being written out.
+struct TraceBuffer
+{
+    mutex m;
+    uint32_t tid;
+    string threadName;
+    vector<TraceEvent> events;
+};
+
+mutex registryMutex;
+vector<shared_ptr<TraceBuffer>> registry;
+uint32_t nextTid = 1;
+atomic<int64_t> sessionStart{0};
+
+int64_t steadyNanos()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TraceBuffer &localBuffer()
+{
+    // The registry keeps buffers alive after their thread exits, so events
+    // from short-lived threads still reach the file.
+    thread_local shared_ptr<TraceBuffer> buffer;
+    if (!buffer)
+    {
+        buffer = make_shared<TraceBuffer>();
+        buffer->events.reserve(4096);
+        lock_guard<mutex> lock(registryMutex);
+        buffer->tid = nextTid++;
+        registry.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void appendEscaped(string &out, const string &s)
+{
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+        out += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20)
+        out += c;
+    }
+}
+}
+
+int64_t traceNow()
+{
+    return steadyNanos() - sessionStart.load(memory_order_relaxed);
+}
+
+void traceRecord(const char *name, const char *category, int64_t start, int64_t end)
+{
+    TraceBuffer &buffer = localBuffer();
+    lock_guard<mutex> lock(buffer.m);
+    buffer.events.push_back({name, category, start, end});
+}
+
+void traceThreadName(const string &name)
+{
+    TraceBuffer &buffer = localBuffer();
+    lock_guard<mutex> lock(buffer.m);
+    buffer.threadName = name;
+}
+
+TraceSession::TraceSession(string path) : path(move(path))
+{
+    if (this->path.empty() || traceActive.load())
+    return;
+
+    {
+        lock_guard<mutex> lock(registryMutex);
+        for (auto &buffer : registry)
+        {
+            lock_guard<mutex> bufferLock(buffer->m);
+            buffer->events.clear();
+        }
+    }
+    sessionStart = steadyNanos();
+    traceActive = true;
+    active = true;
+}
+
+TraceSession::~TraceSession()
+{
+    if (active)
+    write();
+}
+
+bool TraceSession::write()
+{
+    if (!active)
+    return false;
+    traceActive = false;
+    active = false;
+
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f)
+    return false;
+
+    string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    char line[256];
+    lock_guard<mutex> lock(registryMutex);
+    for (auto &buffer : registry)
+    {
+        lock_guard<mutex> bufferLock(buffer->m);
+        if (!buffer->threadName.empty())
+        {
+            out += first ? "" : ",\n";
+            out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + to_string(buffer->tid) + ",\"args\":{\"name\":\"";
+            appendEscaped(out, buffer->threadName);
+            out += "\"}}";
+            first = false;
+        }
+        for (const TraceEvent &e : buffer->events)
+        {
+            snprintf(line, sizeof(line), "%s{\"ph\":\"X\",\"name\":\"%s\",\"cat\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                     first ? "" : ",\n", e.name, e.category, buffer->tid, e.start / 1000.0, (e.end - e.start) / 1000.0);
+            out += line;
+            first = false;
+        }
+        buffer->events.clear();
+        if (out.size() > (1 << 20))
+        {
+            fwrite(out.data(), 1, out.size(), f);
+            out.clear();
+        }
+    }
+    out += "\n]}\n";
+    fwrite(out.data(), 1, out.size(), f);
+    return fclose(f) == 0;
+}
@@ -0,0 +1,86 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Scoped wall-time markers written as Chrome trace_event JSON (load the file
+// in chrome://tracing or ui.perfetto.dev). Events go to a per-thread buffer
+// without locking anything shared; a TraceSession turns recording on and
+// writes every thread's buffer out when it ends.
+//
+// While no session is active a TRACE_SCOPE costs one relaxed atomic load.
+// Build with -DFLIGHT_TRACE=0 to remove the markers entirely.
+#ifndef FLIGHT_TRACE
+#define FLIGHT_TRACE 1
+#endif
+
+extern std::atomic<bool> traceActive;
+
+inline bool traceEnabled()
+{
+    return traceActive.load(std::memory_order_relaxed);
+}
+
+// Nanoseconds since the active session started.
+std::int64_t traceNow();
+
+void traceRecord(const char *name, const char *category, std::int64_t start, std::int64_t end);
+
+// Labels the calling thread in the trace viewer.
+void traceThreadName(const std::string &name);
+
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name, const char *category = "routing")
+        : name(traceEnabled() ? name : nullptr), category(category), start(this->name ? traceNow() : 0)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (name)
+        traceRecord(name, category, start, traceNow());
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name;
+    const char *category;
+    std::int64_t start;
+};
+
+// Records for as long as it lives, then writes the trace to `path`. Only one
+// session may be active at a time; an empty path makes it a no-op.
+class TraceSession
+{
+public:
+    explicit TraceSession(std::string path);
+    ~TraceSession();
+
+    TraceSession(const TraceSession &) = delete;
+    TraceSession &operator=(const TraceSession &) = delete;
+
+    bool write();
+
+private:
+    std::string path;
+    bool active = false;
+};
+
+#define TRACE_JOIN_(a, b) a##b
+#define TRACE_JOIN(a, b) TRACE_JOIN_(a, b)
+
+#if FLIGHT_TRACE
+#define TRACE_SCOPE(name) TraceScope TRACE_JOIN(traceScope, __LINE__)(name)
+#define TRACE_SCOPE_CAT(name, category) TraceScope TRACE_JOIN(traceScope, __LINE__)(name, category)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_SCOPE_CAT(name, category) ((void)0)
+#endif
+
+#endif
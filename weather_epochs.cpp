@@ -0,0 +1,122 @@
+#include "weather_epochs.h"
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+using namespace std;
+
+WeatherEpochStore::WeatherEpochStore(const FlightGraph &graph, int maxReaders) : readers(max(1, maxReaders))
+{
+    auto *initial = new WeatherSnapshot();
+    int n = graph.airports.size();
+    initial->airportCount = n;
+    size_t cells = size_t(n) * n;
+    size_t pageCount = (cells + WeatherSnapshot::kPageSize - 1) / WeatherSnapshot::kPageSize;
+    for (size_t p = 0; p < pageCount; ++p)
+    {
+        auto page = make_shared<WeatherSnapshot::Page>();
+        for (size_t j = 0; j < WeatherSnapshot::kPageSize; ++j)
+        {
+            size_t i = p * WeatherSnapshot::kPageSize + j;
+            if (i >= cells)
+            {
+                (*page)[j] = {descriptions.c_str(0), false, false};
+                continue;
+            }
+            int u = i / n, v = i % n;
+            const auto &weather = graph.pathWeather[u][v];
+            StrId description = descriptions.intern(graph.strings->view(weather.description));
+            (*page)[j] = {descriptions.c_str(description), bool(graph.pathAvailable[u][v]), weather.isBad};
+        }
+        initial->pages.push_back(move(page));
+    }
+    current.store(initial);
+}
+
+WeatherEpochStore::~WeatherEpochStore()
+{
+    delete current.load();
+    for (auto &[epoch, snapshot] : retired)
+    delete snapshot;
+}
+
+WeatherEpochStore::Pin WeatherEpochStore::pin()
+{
+    size_t start = hash<thread::id>()(this_thread::get_id());
+    int slots = readers.size();
+    for (;;)
+    {
+        for (int k = 0; k < slots; ++k)
+        {
+            int slot = (start + k) % slots;
+            bool expected = false;
+            if (!readers[slot].claimed.load(memory_order_relaxed) &&
+                readers[slot].claimed.compare_exchange_strong(expected, true, memory_order_acquire))
+            {
+                readers[slot].epoch.store(globalEpoch.load());
+                return Pin(*this, slot, current.load());
+            }
+        }
+        this_thread::yield();
+    }
+}
+
+uint64_t WeatherEpochStore::publish(const vector<WeatherUpdate> &batch, const function<void(uint64_t)> &beforeSwap)
+{
+    lock_guard<mutex> lock(writerMutex);
+    const WeatherSnapshot *old = current.load();
+    auto next = make_unique<WeatherSnapshot>(*old);
+    next->epoch = old->epoch + 1;
+
+    unordered_map<size_t, shared_ptr<WeatherSnapshot::Page>> copied;
+    auto write = [&](int u, int v, const EdgeWeather &value)
+    {
+        size_t i = size_t(u) * next->airportCount + v;
+        size_t p = i >> WeatherSnapshot::kPageShift;
+        auto &page = copied[p];
+        if (!page)
+        {
+            page = make_shared<WeatherSnapshot::Page>(*next->pages[p]);
+            next->pages[p] = page;
+        }
+        (*page)[i & (WeatherSnapshot::kPageSize - 1)] = value;
+    };
+
+    for (const auto &update : batch)
+    {
+        const char *description = descriptions.c_str(descriptions.intern(update.description));
+        EdgeWeather value{description, !update.isBad, update.isBad};
+        write(update.u, update.v, value);
+        write(update.v, update.u, value);
+    }
+
+    if (beforeSwap)
+    beforeSwap(next->epoch);
+    uint64_t epoch = next->epoch;
+    current.store(next.release());
+    retired.push_back({globalEpoch.fetch_add(1), old});
+    reclaim();
+    return epoch;
+}
+
+size_t WeatherEpochStore::retiredCount()
+{
+    lock_guard<mutex> lock(writerMutex);
+    return retired.size();
+}
+
+void WeatherEpochStore::reclaim()
+{
+    uint64_t oldestPinned = kIdle;
+    for (const auto &reader : readers)
+    oldestPinned = min(oldestPinned, reader.epoch.load());
+
+    auto keep = retired.begin();
+    for (auto it = retired.begin(); it != retired.end(); ++it)
+    {
+        if (it->first < oldestPinned)
+        delete it->second;
+        else
+        *keep++ = *it;
+    }
+    retired.erase(keep, retired.end());
+}
@@ -0,0 +1,145 @@
+#ifndef WEATHER_EPOCHS_H
+#define WEATHER_EPOCHS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "flight_graph.h"
+
+struct EdgeWeather
+{
+    const char *description;
+    bool available;
+    bool isBad;
+};
+
+// Immutable view of every edge's weather at one epoch. The n x n edge
+// attributes are split into fixed-size pages that consecutive snapshots
+// share; publishing copies only the pages a batch actually touches.
+struct WeatherSnapshot
+{
+    static constexpr std::size_t kPageShift = 10;
+    static constexpr std::size_t kPageSize = std::size_t(1) << kPageShift;
+    using Page = std::array<EdgeWeather, kPageSize>;
+
+    std::uint64_t epoch = 0;
+    int airportCount = 0;
+    std::vector<std::shared_ptr<const Page>> pages;
+
+    const EdgeWeather &at(int u, int v) const
+    {
+        std::size_t i = std::size_t(u) * airportCount + v;
+        return (*pages[i >> kPageShift])[i & (kPageSize - 1)];
+    }
+
+    bool available(int u, int v) const { return at(u, v).available; }
+    bool isBad(int u, int v) const { return at(u, v).isBad; }
+    std::string_view weatherDescription(int u, int v) const { return at(u, v).description; }
+
+    auto availability() const
+    {
+        return [this](int u, int v) { return at(u, v).available; };
+    }
+};
+
+// Publishes weather as a sequence of immutable WeatherSnapshots. Readers pin
+// the current epoch and search it without taking any lock; a single writer
+// applies batches and swaps the new snapshot in atomically. Replaced
+// snapshots are reclaimed once every pinned reader has moved past the epoch
+// in which they were retired (epoch-based reclamation).
+//
+// The FlightGraph topology (airports, adj) must not change while the store
+// is in use; weather lives only in the store from then on.
+//
+// Each live Pin holds one of a fixed number of reader slots, and pin()
+// spins while all of them are taken. Size the store for the threads that
+// can hold a pin at once (e.g. a server's worker pool), not a fixed guess.
+class WeatherEpochStore
+{
+public:
+    static constexpr int kDefaultReaders = 64;
+
+    class Pin
+    {
+    public:
+        Pin(WeatherEpochStore &store, int slot, const WeatherSnapshot *snapshot)
+            : store(&store), slot(slot), snapshot(snapshot)
+        {
+        }
+
+        Pin(Pin &&other) noexcept
+            : store(other.store), slot(other.slot), snapshot(other.snapshot)
+        {
+            other.store = nullptr;
+        }
+
+        Pin(const Pin &) = delete;
+        Pin &operator=(const Pin &) = delete;
+        Pin &operator=(Pin &&) = delete;
+
+        ~Pin()
+        {
+            if (store)
+            store->unpin(slot);
+        }
+
+        const WeatherSnapshot &operator*() const { return *snapshot; }
+        const WeatherSnapshot *operator->() const { return snapshot; }
+
+    private:
+        WeatherEpochStore *store;
+        int slot;
+        const WeatherSnapshot *snapshot;
+    };
+
+    // `maxReaders` is how many Pins may be held at the same time.
+    explicit WeatherEpochStore(const FlightGraph &graph, int maxReaders = kDefaultReaders);
+    ~WeatherEpochStore();
+
+    WeatherEpochStore(const WeatherEpochStore &) = delete;
+    WeatherEpochStore &operator=(const WeatherEpochStore &) = delete;
+
+    Pin pin();
+
+    // Applies a batch of updates as one new epoch and returns its number.
+    // `beforeSwap`, if given, runs under the writer lock with the number of
+    // the epoch about to become visible (used to invalidate derived caches).
+    std::uint64_t publish(const std::vector<WeatherUpdate> &batch,
+                          const std::function<void(std::uint64_t)> &beforeSwap = nullptr);
+
+    std::size_t retiredCount();
+
+private:
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<std::uint64_t> epoch{kIdle};
+        std::atomic<bool> claimed{false};
+    };
+
+    static constexpr std::uint64_t kIdle = std::numeric_limits<std::uint64_t>::max();
+
+    void unpin(int slot)
+    {
+        readers[slot].epoch.store(kIdle, std::memory_order_release);
+        readers[slot].claimed.store(false, std::memory_order_release);
+    }
+
+    void reclaim();
+
+    std::atomic<const WeatherSnapshot *> current{nullptr};
+    std::atomic<std::uint64_t> globalEpoch{1};
+    std::vector<ReaderSlot> readers;
+
+    std::mutex writerMutex;
+    StringPool descriptions;
+    std::vector<std::pair<std::uint64_t, const WeatherSnapshot *>> retired;
+};
+
+#endif
@@ -0,0 +1,99 @@
+#include "weather_grid.h"
+using namespace std;
+
+bool WeatherGrid::build(const FlightGraph &graph, float size)
+{
+    float minX = numeric_limits<float>::max(), minY = minX;
+    float maxX = numeric_limits<float>::lowest(), maxY = maxX;
+    for (const auto &airport : graph.airports)
+    {
+        minX = min(minX, airport.position.x);
+        minY = min(minY, airport.position.y);
+        maxX = max(maxX, airport.position.x);
+        maxY = max(maxY, airport.position.y);
+    }
+    if (graph.airports.empty())
+    minX = minY = maxX = maxY = 0;
+
+    // Counted in double so that a tiny size cannot overflow before the check.
+    double colCount = floor((double(maxX) - minX) / size) + 1;
+    double rowCount = floor((double(maxY) - minY) / size) + 1;
+    if (!(colCount * rowCount <= kMaxCells))
+    return false;
+
+    cellSize = size;
+    originX = minX;
+    originY = minY;
+    cols = static_cast<int>(colCount);
+    rows = static_cast<int>(rowCount);
+    edges.clear();
+    for (int u = 0; u < static_cast<int>(graph.adj.size()); ++u)
+    for (auto [v, w] : graph.adj[u])
+    if (u < v)
+    edges.push_back({u, v});
+
+    cellStart.assign(cols * rows + 1, 0);
+    for (const auto &[u, v] : edges)
+    {
+        forEachCellOnSegment(graph.airports[u].position, graph.airports[v].position,
+        [&](int cell) { ++cellStart[cell + 1]; });
+    }
+    for (int c = 0; c < cols * rows; ++c)
+    cellStart[c + 1] += cellStart[c];
+
+    cellEdges.assign(cellStart.back(), 0);
+    vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+    for (int e = 0; e < static_cast<int>(edges.size()); ++e)
+    {
+        auto [u, v] = edges[e];
+        forEachCellOnSegment(graph.airports[u].position, graph.airports[v].position,
+        [&](int cell) { cellEdges[fill[cell]++] = e; });
+    }
+
+    badCellCount.assign(edges.size(), 0);
+    cellBad.assign(cols * rows, false);
+    return true;
+}
+
+int WeatherGrid::cellAt(float x, float y) const
+{
+    // Range-checked before the cast, which is undefined for far-off points.
+    float cx = floor((x - originX) / cellSize);
+    float cy = floor((y - originY) / cellSize);
+    if (!(cx >= 0 && cy >= 0 && cx < cols && cy < rows))
+    return -1;
+    return static_cast<int>(cy) * cols + static_cast<int>(cx);
+}
+
+void WeatherGrid::setCell(int cell, bool isBad, string_view description, vector<WeatherUpdate> &changes)
+{
+    if (cell < 0 || cell >= cols * rows)
+    return;
+
+    bool wasBad = cellBad[cell];
+    cellBad[cell] = isBad;
+
+    for (int i = cellStart[cell]; i < cellStart[cell + 1]; ++i)
+    {
+        int e = cellEdges[i];
+        auto [u, v] = edges[e];
+        if (isBad)
+        {
+            if (!wasBad)
+            ++badCellCount[e];
+            changes.push_back({u, v, true, string(description)});
+        }
+        else if (wasBad && --badCellCount[e] == 0)
+        {
+            changes.push_back({u, v, false, string(description)});
+        }
+    }
+}
+
+int WeatherGrid::setCell(FlightGraph &graph, int cell, bool isBad, string_view description)
+{
+    vector<WeatherUpdate> changes;
+    setCell(cell, isBad, description, changes);
+    graph.applyWeather(changes);
+    return changes.size();
+}
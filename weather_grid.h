@@ -0,0 +1,95 @@
+#ifndef WEATHER_GRID_H
+#define WEATHER_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "flight_graph.h"
+
+// Uniform grid over the map used to apply gridded (radar tile) weather.
+// Each cell knows, through a CSR inverted index built by rasterising every
+// edge segment, which edges cross it, so marking a cell touches only those.
+// An edge stays bad while at least one bad cell covers it.
+struct WeatherGrid
+{
+    // Upper bound on cols * rows, so a tiny cell size cannot exhaust memory.
+    static constexpr int kMaxCells = 1 << 22;
+
+    float originX = 0, originY = 0;
+    float cellSize = 1;
+    int cols = 0, rows = 0;
+
+    std::vector<std::pair<int, int>> edges;
+    std::vector<int> cellStart;
+    std::vector<int> cellEdges;
+    std::vector<int> badCellCount;
+    std::vector<bool> cellBad;
+
+    // `size` is the side of a cell in map units and must be positive.
+    // Returns false, leaving the grid unchanged, if the map would need more
+    // than kMaxCells cells.
+    bool build(const FlightGraph &graph, float size);
+
+    int cellAt(float x, float y) const;
+
+    // Visits every cell the segment a-b passes through exactly once
+    // (Amanatides-Woo grid traversal).
+    template <typename Visit>
+    void forEachCellOnSegment(Vec2 a, Vec2 b, Visit &&visit) const
+    {
+        double ax = (a.x - originX) / cellSize, ay = (a.y - originY) / cellSize;
+        double bx = (b.x - originX) / cellSize, by = (b.y - originY) / cellSize;
+        int cx = std::clamp(static_cast<int>(std::floor(ax)), 0, cols - 1);
+        int cy = std::clamp(static_cast<int>(std::floor(ay)), 0, rows - 1);
+        int ex = std::clamp(static_cast<int>(std::floor(bx)), 0, cols - 1);
+        int ey = std::clamp(static_cast<int>(std::floor(by)), 0, rows - 1);
+
+        double dx = bx - ax, dy = by - ay;
+        int stepX = dx > 0 ? 1 : -1;
+        int stepY = dy > 0 ? 1 : -1;
+        const double inf = std::numeric_limits<double>::infinity();
+        double tDeltaX = dx != 0 ? 1.0 / std::fabs(dx) : inf;
+        double tDeltaY = dy != 0 ? 1.0 / std::fabs(dy) : inf;
+        double tMaxX = dx != 0 ? (stepX > 0 ? cx + 1 - ax : ax - cx) * tDeltaX : inf;
+        double tMaxY = dy != 0 ? (stepY > 0 ? cy + 1 - ay : ay - cy) * tDeltaY : inf;
+
+        visit(cy * cols + cx);
+        int steps = std::abs(ex - cx) + std::abs(ey - cy);
+        for (int i = 0; i < steps; ++i)
+        {
+            bool stepInX = tMaxX < tMaxY ? cx != ex : cy == ey;
+            if (stepInX)
+            {
+                cx += stepX;
+                tMaxX += tDeltaX;
+            }
+            else
+            {
+                cy += stepY;
+                tMaxY += tDeltaY;
+            }
+            visit(cy * cols + cx);
+        }
+    }
+
+    // Marks a cell bad or clear and appends the resulting per-edge changes
+    // to `changes`, for callers that apply weather in batches (e.g. through
+    // a WeatherEpochStore).
+    void setCell(int cell, bool isBad, std::string_view description, std::vector<WeatherUpdate> &changes);
+
+    // Marks a cell bad or clear and writes the result through to the graph's
+    // pathAvailable/pathWeather state. Returns the number of edges whose
+    // weather changed.
+    int setCell(FlightGraph &graph, int cell, bool isBad, std::string_view description);
+
+    int setCell(FlightGraph &graph, float x, float y, bool isBad, std::string_view description)
+    {
+        return setCell(graph, cellAt(x, y), isBad, description);
+    }
+};
+
+#endif
@@ -0,0 +1,275 @@
+#include "weather_history.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+using namespace std;
+
+namespace
+{
+const char kFileMagic[8] = {'W', 'X', 'H', 'I', 'S', 'T', '1', '\n'};
+
+void appendVarint(vector<uint8_t> &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+// Bounds-checked, for reading files.
+bool parseVarint(const vector<uint8_t> &in, size_t &offset, uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && offset < in.size(); shift += 7)
+    {
+        uint8_t byte = in[offset++];
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        return true;
+    }
+    return false;
+}
+} // namespace
+
+WeatherHistory::WeatherHistory(const FlightGraph &graph, int64_t startTime, size_t checkpointInterval)
+    : airportCount(graph.airports.size()), interval(max<size_t>(1, checkpointInterval))
+{
+    Checkpoint initial{startTime, 0, 0, vector<uint32_t>(pairCount())};
+    for (int u = 0; u < airportCount; ++u)
+    for (int v = u + 1; v < airportCount; ++v)
+    {
+        StrId description = descriptions.intern(graph.weatherDescription(u, v));
+        initial.state[pairIndex(u, v)] = packState(description, graph.available(u, v), graph.isBad(u, v));
+    }
+    state = initial.state;
+    lastTimestamp = startTime;
+    checkpoints.push_back(move(initial));
+}
+
+bool WeatherHistory::record(int64_t timestamp, int u, int v, bool isBad, string_view description)
+{
+    if (timestamp < lastTimestamp || u == v)
+    return false;
+    if (u > v)
+    swap(u, v);
+
+    StrId id = descriptions.intern(description);
+    appendVarint(log, uint64_t(timestamp - lastTimestamp));
+    appendVarint(log, pairIndex(u, v));
+    appendVarint(log, (uint64_t(id) << 1) | (isBad ? 1 : 0));
+    lastTimestamp = timestamp;
+    state[pairIndex(u, v)] = packState(id, !isBad, isBad);
+
+    if (++events % interval == 0)
+    checkpoints.push_back({timestamp, log.size(), events, state});
+    return true;
+}
+
+WeatherHistory::State WeatherHistory::stateAt(int64_t timestamp) const
+{
+    const Checkpoint &start = checkpointAt(timestamp);
+    State past;
+    past.history = this;
+    past.cells = start.state;
+    size_t offset = start.offset;
+    int64_t t = start.timestamp;
+    StrId id;
+    while (offset < log.size())
+    {
+        Event event = decode(offset, t, id);
+        if (event.timestamp > timestamp)
+        break;
+        past.cells[pairIndex(event.u, event.v)] = packState(id, !event.isBad, event.isBad);
+    }
+    return past;
+}
+
+void WeatherHistory::restore(FlightGraph &graph, int64_t timestamp) const
+{
+    State past = stateAt(timestamp);
+    vector<StrId> graphIds(descriptions.size(), numeric_limits<StrId>::max());
+    for (int u = 0; u < airportCount; ++u)
+    for (int v = u + 1; v < airportCount; ++v)
+    {
+        uint32_t cell = past.cells[pairIndex(u, v)];
+        StrId id = cell >> 2;
+        if (graphIds[id] == numeric_limits<StrId>::max())
+        graphIds[id] = graph.strings->intern(descriptions.view(id));
+        bool isBad = cell & 1;
+        bool available = cell & 2;
+        graph.pathWeather[u][v] = graph.pathWeather[v][u] = {isBad, graphIds[id]};
+        graph.pathAvailable[u][v] = graph.pathAvailable[v][u] = available;
+    }
+}
+
+// File layout after the magic, all LEB128 varints unless noted: airport
+// count, start time, description count, each description as its length
+// and bytes, the packed state of every pair at the start, then the log's
+// length and bytes exactly as recorded.
+bool WeatherHistory::save(const string &path) const
+{
+    vector<uint8_t> out(kFileMagic, kFileMagic + sizeof(kFileMagic));
+    appendVarint(out, uint64_t(airportCount));
+    appendVarint(out, uint64_t(startTime()));
+    appendVarint(out, descriptions.size());
+    for (StrId id = 0; id < descriptions.size(); ++id)
+    {
+        string_view text = descriptions.view(id);
+        appendVarint(out, text.size());
+        out.insert(out.end(), text.begin(), text.end());
+    }
+    for (uint32_t cell : checkpoints.front().state)
+    appendVarint(out, cell);
+    appendVarint(out, log.size());
+    out.insert(out.end(), log.begin(), log.end());
+
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f)
+    return false;
+    bool written = fwrite(out.data(), 1, out.size(), f) == out.size();
+    return fclose(f) == 0 && written;
+}
+
+bool WeatherHistory::load(const string &path)
+{
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f)
+    return false;
+    vector<uint8_t> in;
+    uint8_t chunk[1 << 16];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    in.insert(in.end(), chunk, chunk + got);
+    fclose(f);
+
+    // Everything is parsed and checked before the history is touched.
+    size_t offset = sizeof(kFileMagic);
+    if (in.size() < offset || memcmp(in.data(), kFileMagic, offset) != 0)
+    return false;
+    uint64_t airports, start, count;
+    if (!parseVarint(in, offset, airports) || airports != uint64_t(airportCount) || !parseVarint(in, offset, start) ||
+        !parseVarint(in, offset, count) || count > in.size())
+    return false;
+    vector<string> texts(count);
+    for (string &text : texts)
+    {
+        uint64_t length;
+        if (!parseVarint(in, offset, length) || length > in.size() - offset)
+        return false;
+        text.assign(in.begin() + offset, in.begin() + offset + length);
+        offset += length;
+    }
+    vector<uint32_t> initial(pairCount());
+    for (uint32_t &cell : initial)
+    {
+        uint64_t value;
+        if (!parseVarint(in, offset, value) || (value >> 2) >= count)
+        return false;
+        cell = uint32_t(value);
+    }
+    uint64_t logSize;
+    if (!parseVarint(in, offset, logSize) || logSize != in.size() - offset)
+    return false;
+
+    struct Saved
+    {
+        int64_t timestamp;
+        uint64_t pair;
+        uint64_t payload;
+    };
+    vector<Saved> saved;
+    int64_t timestamp = int64_t(start);
+    while (offset < in.size())
+    {
+        uint64_t delta, pair, payload;
+        if (!parseVarint(in, offset, delta) || !parseVarint(in, offset, pair) || !parseVarint(in, offset, payload) ||
+            pair >= pairCount() || (payload >> 1) >= count)
+        return false;
+        timestamp += int64_t(delta);
+        saved.push_back({timestamp, pair, payload});
+    }
+
+    // Handles in the file need not match this pool's, so the initial state
+    // is remapped and the events recorded again.
+    vector<StrId> ids;
+    for (const string &text : texts)
+    ids.push_back(descriptions.intern(text));
+    for (uint32_t &cell : initial)
+    cell = (ids[cell >> 2] << 2) | (cell & 3);
+    checkpoints.assign(1, {int64_t(start), 0, 0, initial});
+    state = move(initial);
+    log.clear();
+    events = 0;
+    lastTimestamp = int64_t(start);
+    for (const Saved &event : saved)
+    {
+        int u, v;
+        pairFromIndex(event.pair, u, v);
+        record(event.timestamp, u, v, event.payload & 1, texts[event.payload >> 1]);
+    }
+    return true;
+}
+
+void WeatherHistory::pairFromIndex(uint64_t index, int &u, int &v) const
+{
+    // Counted back from the last pair, the rows have lengths 1, 2, 3, ...,
+    // so the row is the inverse triangular number of that count. The
+    // floating-point root is at most one row off either way.
+    uint64_t n = airportCount;
+    uint64_t fromEnd = n * (n - 1) / 2 - 1 - index;
+    uint64_t k = uint64_t((sqrt(8.0 * double(fromEnd) + 1) - 1) / 2);
+    while (k > 0 && k * (k + 1) / 2 > fromEnd)
+    --k;
+    while ((k + 1) * (k + 2) / 2 <= fromEnd)
+    ++k;
+    u = int(n - 2 - k);
+    v = u + 1 + int(index - pairIndex(u, u + 1));
+}
+
+uint64_t WeatherHistory::readVarint(size_t &offset) const
+{
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7)
+    {
+        uint8_t byte = log[offset++];
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        return value;
+    }
+}
+
+WeatherHistory::Event WeatherHistory::decode(size_t &offset, int64_t &timestamp) const
+{
+    StrId description;
+    return decode(offset, timestamp, description);
+}
+
+WeatherHistory::Event WeatherHistory::decode(size_t &offset, int64_t &timestamp, StrId &description) const
+{
+    timestamp += int64_t(readVarint(offset));
+    Event event;
+    event.timestamp = timestamp;
+    pairFromIndex(readVarint(offset), event.u, event.v);
+    uint64_t payload = readVarint(offset);
+    event.isBad = payload & 1;
+    description = StrId(payload >> 1);
+    event.description = descriptions.view(description);
+    return event;
+}
+
+const WeatherHistory::Checkpoint &WeatherHistory::checkpointAt(int64_t timestamp) const
+{
+    auto it = upper_bound(checkpoints.begin() + 1, checkpoints.end(), timestamp,
+    [](int64_t t, const Checkpoint &c) { return t < c.timestamp; });
+    return *prev(it);
+}
+
+const WeatherHistory::Checkpoint &WeatherHistory::checkpointBefore(int64_t timestamp) const
+{
+    auto it = lower_bound(checkpoints.begin() + 1, checkpoints.end(), timestamp,
+    [](const Checkpoint &c, int64_t t) { return c.timestamp < t; });
+    return *prev(it);
+}
@@ -0,0 +1,191 @@
+#ifndef WEATHER_HISTORY_H
+#define WEATHER_HISTORY_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "flight_graph.h"
+
+// Milliseconds since the Unix epoch: the clock the tools stamp recorded
+// weather with.
+inline std::int64_t unixMillis()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// Append-only log of weather events. Each event is delta-encoded as three
+// LEB128 varints (milliseconds since the previous event, airport pair,
+// description handle + bad flag), which is typically 4-6 bytes. Every
+// `checkpointInterval` events the full per-pair state is checkpointed, so
+// reconstructing any timestamp costs one checkpoint copy plus at most
+// `checkpointInterval` decoded events.
+class WeatherHistory
+{
+public:
+    struct Event
+    {
+        std::int64_t timestamp;
+        int u;
+        int v;
+        bool isBad;
+        std::string_view description;
+    };
+
+    // Weather in effect at one time, usable as planRoute()'s `weather`. It
+    // reads descriptions from the history, so it must not be used while the
+    // history is recorded into on another thread.
+    class State
+    {
+    public:
+        bool available(int u, int v) const { return cell(u, v) & 2; }
+        bool isBad(int u, int v) const { return cell(u, v) & 1; }
+        std::string_view weatherDescription(int u, int v) const
+        {
+            return history->descriptions.view(cell(u, v) >> 2);
+        }
+
+    private:
+        friend class WeatherHistory;
+
+        std::uint32_t cell(int u, int v) const
+        {
+            if (u == v)
+            return 0;
+            return cells[u < v ? history->pairIndex(u, v) : history->pairIndex(v, u)];
+        }
+
+        const WeatherHistory *history;
+        std::vector<std::uint32_t> cells;
+    };
+
+    WeatherHistory(const FlightGraph &graph, std::int64_t startTime, std::size_t checkpointInterval = 1024);
+
+    // Appends an event; timestamps (ms) must not go backwards.
+    bool record(std::int64_t timestamp, int u, int v, bool isBad, std::string_view description);
+
+    // Calls onEvent for every event with from <= timestamp <= to, in order.
+    template <typename OnEvent>
+    void forEachEvent(std::int64_t from, std::int64_t to, OnEvent &&onEvent) const
+    {
+        const Checkpoint &start = checkpointBefore(from);
+        std::size_t offset = start.offset;
+        std::int64_t timestamp = start.timestamp;
+        while (offset < log.size())
+        {
+            Event event = decode(offset, timestamp);
+            if (event.timestamp > to)
+            break;
+            if (event.timestamp >= from)
+            onEvent(event);
+        }
+    }
+
+    // Weather in effect at `timestamp`: the state at the start for earlier
+    // times, the latest for later ones.
+    State stateAt(std::int64_t timestamp) const;
+
+    // Rewrites the graph's weather to the state in effect at `timestamp`.
+    void restore(FlightGraph &graph, std::int64_t timestamp) const;
+
+    // Writes the history to `path`; false if it cannot be written.
+    bool save(const std::string &path) const;
+
+    // Replaces this history with the one saved in `path`, which must have
+    // been recorded for a graph with as many airports. Returns false, leaving
+    // the history unchanged, if the file is missing, truncated or does not
+    // match.
+    bool load(const std::string &path);
+
+    std::size_t eventCount() const { return events; }
+    std::size_t checkpointCount() const { return checkpoints.size(); }
+    std::size_t logBytes() const { return log.size(); }
+    std::int64_t startTime() const { return checkpoints.front().timestamp; }
+    std::int64_t endTime() const { return lastTimestamp; }
+
+private:
+    struct Checkpoint
+    {
+        std::int64_t timestamp;
+        std::size_t offset;
+        std::size_t eventIndex;
+        std::vector<std::uint32_t> state;
+    };
+
+    std::size_t pairCount() const
+    {
+        return std::size_t(airportCount) * (airportCount - 1) / 2;
+    }
+
+    std::uint64_t pairIndex(int u, int v) const
+    {
+        return std::uint64_t(u) * airportCount - std::uint64_t(u) * (u + 1) / 2 + (v - u - 1);
+    }
+
+    static std::uint32_t packState(StrId description, bool available, bool isBad)
+    {
+        return (description << 2) | (available ? 2 : 0) | (isBad ? 1 : 0);
+    }
+
+    void pairFromIndex(std::uint64_t index, int &u, int &v) const;
+    std::uint64_t readVarint(std::size_t &offset) const;
+    Event decode(std::size_t &offset, std::int64_t &timestamp) const;
+    // Same, also giving the description's handle in `descriptions`.
+    Event decode(std::size_t &offset, std::int64_t &timestamp, StrId &description) const;
+
+    // Latest checkpoint that folds in no event later than `timestamp`.
+    const Checkpoint &checkpointAt(std::int64_t timestamp) const;
+
+    // Latest checkpoint that folds in no event at or after `timestamp`.
+    const Checkpoint &checkpointBefore(std::int64_t timestamp) const;
+
+    int airportCount;
+    std::size_t interval;
+    std::size_t events = 0;
+    std::int64_t lastTimestamp;
+    std::vector<std::uint8_t> log;
+    std::vector<std::uint32_t> state;
+    std::vector<Checkpoint> checkpoints;
+    StringPool descriptions;
+};
+
+struct TimedRouteQuery
+{
+    std::int64_t timestamp;
+    int src;
+    int dst;
+};
+
+// Replays the history from `from` through `to`, answering each query (sorted
+// by timestamp) against the weather in effect at its timestamp.
+template <typename OnRoute>
+void replayRoutes(const WeatherHistory &history, FlightGraph graph, std::int64_t from, std::int64_t to,
+                  const std::vector<TimedRouteQuery> &queries, OnRoute &&onRoute)
+{
+    history.restore(graph, from);
+    std::size_t next = 0;
+    while (next < queries.size() && queries[next].timestamp < from)
+    ++next;
+
+    auto answerUntil = [&](std::int64_t t)
+    {
+        while (next < queries.size() && queries[next].timestamp < t && queries[next].timestamp <= to)
+        {
+            const auto &query = queries[next++];
+            onRoute(query, planRoute(graph, graph, query.src, query.dst));
+        }
+    };
+
+    history.forEachEvent(from + 1, to, [&](const WeatherHistory::Event &event)
+    {
+        answerUntil(event.timestamp);
+        graph.updateWeather(event.u, event.v, event.isBad, event.description);
+    });
+    answerUntil(std::numeric_limits<std::int64_t>::max());
+}
+
+#endif
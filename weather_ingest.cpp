@@ -0,0 +1,117 @@
+#include "weather_ingest.h"
+#include <string>
+using namespace std;
+
+bool parseWeatherArgs(istringstream &args, const FlightGraph &graph, WeatherUpdate &out)
+{
+    string a, b, condition, description;
+    if (!(args >> a >> b >> condition))
+    return false;
+    getline(args >> ws, description);
+    int u = resolveAirportIndex(a, graph);
+    int v = resolveAirportIndex(b, graph);
+    if (u < 0 || v < 0 || u == v)
+    return false;
+
+    bool isBad = condition == "bad" || condition == "1";
+    if (description.empty())
+    description = isBad ? "Bad weather" : "Clear skies";
+    out = {u, v, isBad, move(description)};
+    return true;
+}
+
+WeatherIngestQueue::WeatherIngestQueue(Apply apply, chrono::milliseconds window)
+    : apply(move(apply)), window(window), rateStart(chrono::steady_clock::now())
+{
+    worker = thread(&WeatherIngestQueue::run, this);
+}
+
+WeatherIngestQueue::~WeatherIngestQueue()
+{
+    {
+        lock_guard<mutex> lock(m);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void WeatherIngestQueue::push(WeatherUpdate update)
+{
+    bool first;
+    {
+        lock_guard<mutex> lock(m);
+        ++received;
+        first = pending.empty();
+        if (first)
+        windowStart = chrono::steady_clock::now();
+
+        auto [it, inserted] = pendingSlot.try_emplace(edgeKey(update.u, update.v), pending.size());
+        if (inserted)
+        pending.push_back(move(update));
+        else
+        {
+            pending[it->second] = move(update);
+            ++coalesced;
+        }
+    }
+    if (first)
+    wake.notify_one();
+}
+
+void WeatherIngestQueue::flush()
+{
+    unique_lock<mutex> lock(m);
+    applyPending(lock);
+}
+
+void WeatherIngestQueue::run()
+{
+    unique_lock<mutex> lock(m);
+    for (;;)
+    {
+        wake.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (!stopping)
+        wake.wait_until(lock, windowStart + window, [this] { return stopping; });
+        applyPending(lock);
+        if (stopping)
+        return;
+    }
+}
+
+// Called with `m` held. The lock is released while the batch is applied so
+// the feed keeps filling the next window; `applying` is only touched here,
+// and applying only one batch at a time keeps batches in arrival order.
+void WeatherIngestQueue::applyPending(unique_lock<mutex> &lock)
+{
+    idle.wait(lock, [this] { return applying.empty(); });
+    if (pending.empty())
+    return;
+
+    applying.swap(pending);
+    pendingSlot.clear();
+    lock.unlock();
+
+    apply(applying);
+
+    lock.lock();
+    applied += applying.size();
+    ++batches;
+    applying.clear();
+    idle.notify_all();
+}
+
+WeatherIngestQueue::Stats WeatherIngestQueue::stats()
+{
+    lock_guard<mutex> lock(m);
+    auto now = chrono::steady_clock::now();
+    double elapsed = chrono::duration<double>(now - rateStart).count();
+    if (elapsed >= 1.0)
+    {
+        uint64_t total = applied;
+        lastRate = (total - rateApplied) / elapsed;
+        rateApplied = total;
+        rateStart = now;
+    }
+    return {received, coalesced, applied, batches, pending.size(), lastRate};
+}
@@ -0,0 +1,89 @@
+#ifndef WEATHER_INGEST_H
+#define WEATHER_INGEST_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "flight_graph.h"
+
+// Parses the arguments of a weather command, "<u> <v> bad|clear
+// [description]", where u and v are indices, codes or names. Returns false
+// for unknown airports or u == v.
+bool parseWeatherArgs(std::istringstream &args, const FlightGraph &graph, WeatherUpdate &out);
+
+// Buffer between a high-rate weather feed and the routing state. Updates
+// pushed within one window are coalesced per edge (last write wins, first
+// arrival keeps its position) and handed to `apply` as a single batch by a
+// background thread, so a burst of N updates to k edges costs one k-edge
+// publish instead of N.
+class WeatherIngestQueue
+{
+public:
+    using Apply = std::function<void(const std::vector<WeatherUpdate> &)>;
+
+    struct Stats
+    {
+        std::uint64_t received;
+        std::uint64_t coalesced;
+        std::uint64_t applied;
+        std::uint64_t batches;
+        std::size_t queueDepth;
+        double appliedPerSecond;
+    };
+
+    explicit WeatherIngestQueue(Apply apply, std::chrono::milliseconds window = std::chrono::milliseconds(20));
+    ~WeatherIngestQueue();
+
+    WeatherIngestQueue(const WeatherIngestQueue &) = delete;
+    WeatherIngestQueue &operator=(const WeatherIngestQueue &) = delete;
+
+    void push(WeatherUpdate update);
+
+    // Applies whatever is pending now instead of waiting for the window.
+    void flush();
+
+    Stats stats();
+
+private:
+    static std::uint64_t edgeKey(int u, int v)
+    {
+        if (u > v)
+        std::swap(u, v);
+        return (std::uint64_t(std::uint32_t(u)) << 32) | std::uint32_t(v);
+    }
+
+    void run();
+    void applyPending(std::unique_lock<std::mutex> &lock);
+
+    Apply apply;
+    std::chrono::milliseconds window;
+
+    std::mutex m;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::vector<WeatherUpdate> pending;
+    std::unordered_map<std::uint64_t, std::size_t> pendingSlot;
+    std::vector<WeatherUpdate> applying;
+    std::chrono::steady_clock::time_point windowStart;
+    bool stopping = false;
+
+    std::uint64_t received = 0;
+    std::uint64_t coalesced = 0;
+    std::atomic<std::uint64_t> applied{0};
+    std::atomic<std::uint64_t> batches{0};
+
+    std::chrono::steady_clock::time_point rateStart;
+    std::uint64_t rateApplied = 0;
+    double lastRate = 0;
+
+    std::thread worker;
+};
+
+#endif
@@ -0,0 +1,158 @@
+// weather_replay.cpp
+// Stands in for a live weather feed: sends "weather <u> <v> bad|clear
+// [description]" lines to route_server's UDP feed port, either replayed
+// from a file or generated at random, at a fixed rate.
+//
+// Usage: weather_replay [--input FILE] [--count N] [--rate N] [--per-datagram N]
+//                       [--hot-edges N] [--host ADDR] [--port N] [--seed N]
+//
+// --rate is updates per second (0 = as fast as possible). Without --input,
+// updates are drawn from the default fifteen airports; --hot-edges N
+// restricts them to N airport pairs so the server has something to coalesce.
+
+#include <SFML/Network.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+using namespace std;
+
+using SteadyClock = chrono::steady_clock;
+
+static const char *airportCodes[] = {"JFK", "LAX", "ORD", "DFW", "ATL", "SFO", "MIA", "SEA",
+                                     "DEN", "BOS", "LAS", "PHX", "IAH", "EWR", "CLT"};
+static const int airportCount = sizeof(airportCodes) / sizeof(airportCodes[0]);
+
+struct ReplayOptions
+{
+    string input;
+    long long count = 100000;
+    long long rate = 0;
+    int perDatagram = 32;
+    int hotEdges = 0;
+    string host = "127.0.0.1";
+    unsigned short port = 5401;
+    unsigned seed = 1;
+};
+
+vector<string> generateUpdates(const ReplayOptions &options)
+{
+    mt19937 rng(options.seed);
+    uniform_int_distribution<int> pick(0, airportCount - 1);
+    auto randomPair = [&]()
+    {
+        int a = pick(rng), b = pick(rng);
+        while (b == a)
+        b = pick(rng);
+        return make_pair(a, b);
+    };
+
+    vector<pair<int, int>> hot;
+    for (int i = 0; i < options.hotEdges; ++i)
+    hot.push_back(randomPair());
+
+    static const char *storms[] = {"Thunderstorms", "Heavy snow", "Fog", "Icing", "Crosswinds"};
+    vector<string> lines;
+    lines.reserve(options.count);
+    for (long long i = 0; i < options.count; ++i)
+    {
+        auto [a, b] = hot.empty() ? randomPair() : hot[rng() % hot.size()];
+        string line = string("weather ") + airportCodes[a] + " " + airportCodes[b];
+        if (rng() % 4 == 0)
+        line += string(" bad ") + storms[rng() % 5];
+        else
+        line += " clear";
+        lines.push_back(move(line));
+    }
+    return lines;
+}
+
+int main(int argc, char *argv[])
+{
+    ReplayOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (i + 1 >= argc)
+        arg = "";
+        if (arg == "--input")
+        options.input = argv[++i];
+        else if (arg == "--count")
+        options.count = max(1LL, stoll(argv[++i]));
+        else if (arg == "--rate")
+        options.rate = max(0LL, stoll(argv[++i]));
+        else if (arg == "--per-datagram")
+        options.perDatagram = max(1, stoi(argv[++i]));
+        else if (arg == "--hot-edges")
+        options.hotEdges = max(0, stoi(argv[++i]));
+        else if (arg == "--host")
+        options.host = argv[++i];
+        else if (arg == "--port")
+        options.port = static_cast<unsigned short>(stoi(argv[++i]));
+        else if (arg == "--seed")
+        options.seed = static_cast<unsigned>(stoul(argv[++i]));
+        else
+        {
+            cerr << "Usage: weather_replay [--input FILE] [--count N] [--rate N] [--per-datagram N]"
+                    " [--hot-edges N] [--host ADDR] [--port N] [--seed N]" << endl;
+            return 1;
+        }
+    }
+
+    vector<string> lines;
+    if (!options.input.empty())
+    {
+        ifstream in(options.input);
+        if (!in)
+        {
+            cerr << "Cannot open input file: " << options.input << endl;
+            return 1;
+        }
+        string line;
+        while (getline(in, line))
+        if (line.compare(0, 8, "weather ") == 0)
+        lines.push_back(line);
+    }
+    else
+    lines = generateUpdates(options);
+
+    sf::UdpSocket socket;
+    sf::IpAddress server(options.host);
+    string datagram;
+    size_t sent = 0, datagrams = 0;
+    auto start = SteadyClock::now();
+    for (size_t i = 0; i < lines.size();)
+    {
+        datagram.clear();
+        size_t end = min(lines.size(), i + options.perDatagram);
+        for (; i < end; ++i)
+        {
+            datagram += lines[i];
+            datagram += '\n';
+        }
+        if (socket.send(datagram.data(), datagram.size(), server, options.port) != sf::Socket::Done)
+        {
+            cerr << "Send failed after " << sent << " updates" << endl;
+            return 1;
+        }
+        sent = i;
+        ++datagrams;
+
+        // Pace against the schedule rather than sleeping a fixed amount per
+        // datagram, so timer slack does not accumulate.
+        if (options.rate > 0)
+        this_thread::sleep_until(start + chrono::microseconds(sent * 1000000 / options.rate));
+    }
+
+    double seconds = chrono::duration<double>(SteadyClock::now() - start).count();
+    cout << "Sent " << sent << " updates in " << datagrams << " datagrams over " << seconds << " s";
+    if (seconds > 0)
+    cout << " (" << static_cast<long long>(sent / seconds) << " updates/s)";
+    cout << endl;
+    return 0;
+}